@@ -72,6 +72,8 @@ ILI9341_t3::ILI9341_t3(uint8_t cs, uint8_t dc, uint8_t rst, uint8_t mosi, uint8_
     native_height = ILI9341_TFTHEIGHT;
 	_width    = native_width;
 	_height   = native_height;
+	_clipx2   = _width;
+	_clipy2   = _height;
 	rotation  = 0;
 	cursor_y  = cursor_x    = 0;
 	textsize  = 1;
@@ -81,6 +83,17 @@ ILI9341_t3::ILI9341_t3(uint8_t cs, uint8_t dc, uint8_t rst, uint8_t mosi, uint8_
 	// Added to see how much impact actually using non hardware CS pin might be
     _cspinmask = 0;
     _csport = NULL;
+	// begin() switches these when the pins belong to another SPI bus
+	_pspi = &SPI;
+	_spi_num = 0;
+#if defined(__IMXRT1052__) || defined(__IMXRT1062__)
+	_pimxrt_spi = &IMXRT_LPSPI4_S;
+	_fifo_depth = 16;
+#elif defined(KINETISK)
+	_pkinetisk_spi = &KINETISK_SPI0;
+	_fifo_depth = 4;
+	_fifo_full_test = (3 << 12);
+#endif
     setBGR();
 }
 
@@ -90,6 +103,7 @@ void ILI9341_t3::setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y
 	setAddr(x0, y0, x1, y1);
 	writecommand_last(ILI9341_RAMWR); // write to RAM
 	endSPITransaction();
+	_gram_valid = false;	// we don't know how many pixels will be pushed
 }
 
 void ILI9341_t3::pushColor(uint16_t color)
@@ -97,81 +111,93 @@ void ILI9341_t3::pushColor(uint16_t color)
 	beginSPITransaction(_clock);
 	writedata16_last(color);
 	endSPITransaction();
+	_gram_valid = false;
 }
 
 void ILI9341_t3::drawPixel(int16_t x, int16_t y, uint16_t color) {
 
-	if((x < 0) ||(x >= _width) || (y < 0) || (y >= _height)) return;
+	x += _originx;
+	y += _originy;
+	if((x < _clipx1) ||(x >= _clipx2) || (y < _clipy1) || (y >= _clipy2)) return;
+	if (_use_fbtft) {
+		fbPixel(x, y, color);
+		return;
+	}
 
 	beginSPITransaction(_clock);
-	setAddr(x, y, x, y);
-	writecommand_cont(ILI9341_RAMWR);
+	beginWrite(x, y, x, y);
 	writedata16_last(color);
 	endSPITransaction();
 }
 
 void ILI9341_t3::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
 {
-	// Rudimentary clipping
-	if((x >= _width) || (x < 0) || (y >= _height)) return;
-	if(y < 0) {	h += y; y = 0; 	}
-	if((y+h-1) >= _height) h = _height-y;
-	beginSPITransaction(_clock);
-	setAddr(x, y, x, y+h-1);
-	writecommand_cont(ILI9341_RAMWR);
-	while (h-- > 1) {
-		writedata16_cont(color);
+	x += _originx;
+	y += _originy;
+	if((x >= _clipx2) || (x < _clipx1) || (y >= _clipy2)) return;
+	if(y < _clipy1) {	h += y - _clipy1; y = _clipy1; 	}
+	if((y+h) > _clipy2) h = _clipy2-y;
+	if(h <= 0) return;
+	if (_use_fbtft) {
+		fbFillRect(x, y, 1, h, color);
+		return;
 	}
-	writedata16_last(color);
+	beginSPITransaction(_clock);
+	beginWrite(x, y, x, y+h-1);
+	writeColor_last(color, h);
 	endSPITransaction();
 }
 
 void ILI9341_t3::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
 {
-	// Rudimentary clipping
-	if((x >= _width) || (y >= _height) || (y < 0)) return;
-	if(x < 0) {	w += x; x = 0; 	}
-	if((x+w-1) >= _width)  w = _width-x;
-	beginSPITransaction(_clock);
-	setAddr(x, y, x+w-1, y);
-	writecommand_cont(ILI9341_RAMWR);
-	while (w-- > 1) {
-		writedata16_cont(color);
+	x += _originx;
+	y += _originy;
+	if((x >= _clipx2) || (y >= _clipy2) || (y < _clipy1)) return;
+	if(x < _clipx1) {	w += x - _clipx1; x = _clipx1; 	}
+	if((x+w) > _clipx2)  w = _clipx2-x;
+	if(w <= 0) return;
+	if (_use_fbtft) {
+		fbFillRect(x, y, w, 1, color);
+		return;
 	}
-	writedata16_last(color);
+	beginSPITransaction(_clock);
+	beginWrite(x, y, x+w-1, y);
+	writeColor_last(color, w);
 	endSPITransaction();
 }
 
 void ILI9341_t3::fillScreen(uint16_t color)
 {
-	fillRect(0, 0, _width, _height, color);
+	fillRect(-_originx, -_originy, _width, _height, color);
 }
 
 // fill a rectangle
 void ILI9341_t3::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 {
-	// rudimentary clipping (drawChar w/big text requires this)
-	if((x >= _width) || (y >= _height)) return;
-	if(x < 0) {	w += x; x = 0; 	}
-	if(y < 0) {	h += y; y = 0; 	}
-	if((x + w - 1) >= _width)  w = _width  - x;
-	if((y + h - 1) >= _height) h = _height - y;
+	x += _originx;
+	y += _originy;
+	if((x >= _clipx2) || (y >= _clipy2)) return;
+	if(x < _clipx1) {	w += x - _clipx1; x = _clipx1; 	}
+	if(y < _clipy1) {	h += y - _clipy1; y = _clipy1; 	}
+	if((x + w) > _clipx2)  w = _clipx2  - x;
+	if((y + h) > _clipy2) h = _clipy2 - y;
+	if((w <= 0) || (h <= 0)) return;
+	if (_use_fbtft) {
+		fbFillRect(x, y, w, h, color);
+		return;
+	}
 
-	// TODO: this can result in a very long transaction time
-	// should break this into multiple transactions, even though
-	// it'll cost more overhead, so we don't stall other SPI libs
+	// break long fills into several transactions, so we don't stall other SPI libs
+	uint32_t slice = rowsPerTransaction(w, h);
 	beginSPITransaction(_clock);
-	setAddr(x, y, x+w-1, y+h-1);
-	writecommand_cont(ILI9341_RAMWR);
-	for(y=h; y>0; y--) {
-		for(x=w; x>1; x--) {
-			writedata16_cont(color);
-		}
-		writedata16_last(color);
-		if (y > 1 && (y & 1)) {
-			endSPITransaction();
-			beginSPITransaction(_clock);
-		}
+	beginWrite(x, y, x+w-1, y+h-1);
+	while (1) {
+		uint32_t rows = (slice < (uint32_t)h) ? slice : h;
+		writeColor_last(color, rows * w);
+		h -= rows;
+		if (h <= 0) break;
+		endSPITransaction();
+		beginSPITransaction(_clock);
 	}
 	endSPITransaction();
 }
@@ -179,33 +205,54 @@ void ILI9341_t3::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c
 // fillRectVGradient	- fills area with vertical gradient
 void ILI9341_t3::fillRectVGradient(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color1, uint16_t color2)
 {
-	// rudimentary clipping (drawChar w/big text requires this)
-	if((x >= _width) || (y >= _height)) return;
-	if((x + w - 1) >= _width)  w = _width  - x;
-	if((y + h - 1) >= _height) h = _height - y;
-	
+	if((w <= 0) || (h <= 0) || clipReject(x, y, w, h)) return;
+	x += _originx;
+	y += _originy;
+	if (_dl_recording) {
+		ILI9341_t3_dlcmd_t *cmd = dlAdd(ILI9341_DL_VGRADIENT, x, y, w, h, color1);
+		if (cmd) cmd->color2 = color2;
+		return;
+	}
+
 	int16_t r1, g1, b1, r2, g2, b2, dr, dg, db, r, g, b;
 	color565toRGB14(color1,r1,g1,b1);
 	color565toRGB14(color2,r2,g2,b2);
 	dr=(r2-r1)/h; dg=(g2-g1)/h; db=(b2-b1)/h;
 	r=r1;g=g1;b=b1;	
 
-	// TODO: this can result in a very long transaction time
-	// should break this into multiple transactions, even though
-	// it'll cost more overhead, so we don't stall other SPI libs
+	// clip, starting the gradient where the first visible row has it
+	if(x < _clipx1) {	w += x - _clipx1; x = _clipx1; 	}
+	if(y < _clipy1) {
+		int16_t skip = _clipy1 - y;
+		r+=dr*skip; g+=dg*skip; b+=db*skip;
+		h -= skip; y = _clipy1;
+	}
+	if((x + w) > _clipx2)  w = _clipx2  - x;
+	if((y + h) > _clipy2) h = _clipy2 - y;
+	if (_use_fbtft) {
+		for(int16_t row=0; row<h; row++) {
+			fbFillRect(x, y+row, w, 1, RGB14tocolor565(r,g,b));
+			r+=dr;g+=dg; b+=db;
+		}
+		return;
+	}
+
+	// break long fills into several transactions, so we don't stall other SPI libs
+	uint32_t slice = rowsPerTransaction(w, h), rows = slice;
 	beginSPITransaction(_clock);
-	setAddr(x, y, x+w-1, y+h-1);
-	writecommand_cont(ILI9341_RAMWR);
+	beginWrite(x, y, x+w-1, y+h-1);
 	for(y=h; y>0; y--) {
 		uint16_t color = RGB14tocolor565(r,g,b);
 
-		for(x=w; x>1; x--) {
-			writedata16_cont(color);
-		}
-		writedata16_last(color);
-		if (y > 1 && (y & 1)) {
-			endSPITransaction();
-			beginSPITransaction(_clock);
+		if (y > 1 && --rows) {
+			writeColor_cont(color, w);
+		} else {
+			writeColor_last(color, w);
+			if (y > 1) {
+				endSPITransaction();
+				beginSPITransaction(_clock);
+				rows = slice;
+			}
 		}
 		r+=dr;g+=dg; b+=db;
 	}
@@ -215,23 +262,45 @@ void ILI9341_t3::fillRectVGradient(int16_t x, int16_t y, int16_t w, int16_t h, u
 // fillRectHGradient	- fills area with horizontal gradient
 void ILI9341_t3::fillRectHGradient(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color1, uint16_t color2)
 {
-	// rudimentary clipping (drawChar w/big text requires this)
-	if((x >= _width) || (y >= _height)) return;
-	if((x + w - 1) >= _width)  w = _width  - x;
-	if((y + h - 1) >= _height) h = _height - y;
-	
+	if((w <= 0) || (h <= 0) || clipReject(x, y, w, h)) return;
+	x += _originx;
+	y += _originy;
+	if (_dl_recording) {
+		ILI9341_t3_dlcmd_t *cmd = dlAdd(ILI9341_DL_HGRADIENT, x, y, w, h, color1);
+		if (cmd) cmd->color2 = color2;
+		return;
+	}
+
 	int16_t r1, g1, b1, r2, g2, b2, dr, dg, db, r, g, b;
 	color565toRGB14(color1,r1,g1,b1);
 	color565toRGB14(color2,r2,g2,b2);
 	dr=(r2-r1)/h; dg=(g2-g1)/h; db=(b2-b1)/h;
-	r=r1;g=g1;b=b1;	
 
-	// TODO: this can result in a very long transaction time
-	// should break this into multiple transactions, even though
-	// it'll cost more overhead, so we don't stall other SPI libs
+	// clip, starting each row where the first visible column has it
+	if(x < _clipx1) {
+		int16_t skip = _clipx1 - x;
+		r1+=dr*skip; g1+=dg*skip; b1+=db*skip;
+		w -= skip; x = _clipx1;
+	}
+	if(y < _clipy1) {	h += y - _clipy1; y = _clipy1; 	}
+	if((x + w) > _clipx2)  w = _clipx2  - x;
+	if((y + h) > _clipy2) h = _clipy2 - y;
+	r=r1;g=g1;b=b1;
+	if (_use_fbtft) {
+		for(int16_t row=0; row<h; row++) {
+			for(int16_t col=0; col<w; col++) {
+				fbFillRect(x+col, y+row, 1, 1, RGB14tocolor565(r,g,b));
+				r+=dr;g+=dg; b+=db;
+			}
+			r=r1;g=g1;b=b1;
+		}
+		return;
+	}
+
+	// break long fills into several transactions, so we don't stall other SPI libs
+	uint32_t slice = rowsPerTransaction(w, h), rows = slice;
 	beginSPITransaction(_clock);
-	setAddr(x, y, x+w-1, y+h-1);
-	writecommand_cont(ILI9341_RAMWR);
+	beginWrite(x, y, x+w-1, y+h-1);
 	for(y=h; y>0; y--) {
 		uint16_t color;
 		for(x=w; x>1; x--) {
@@ -240,10 +309,15 @@ void ILI9341_t3::fillRectHGradient(int16_t x, int16_t y, int16_t w, int16_t h, u
 			r+=dr;g+=dg; b+=db;
 		}
 		color = RGB14tocolor565(r,g,b);
-		writedata16_last(color);
-		if (y > 1 && (y & 1)) {
-			endSPITransaction();
-			beginSPITransaction(_clock);
+		if (y > 1 && --rows) {
+			writedata16_cont(color);
+		} else {
+			writedata16_last(color);
+			if (y > 1) {
+				endSPITransaction();
+				beginSPITransaction(_clock);
+				rows = slice;
+			}
 		}
 		r=r1;g=g1;b=b1;
 	}
@@ -253,13 +327,1141 @@ void ILI9341_t3::fillRectHGradient(int16_t x, int16_t y, int16_t w, int16_t h, u
 // fillScreenVGradient - fills screen with vertical gradient
 void ILI9341_t3::fillScreenVGradient(uint16_t color1, uint16_t color2)
 {
-	fillRectVGradient(0,0,_width,_height,color1,color2);
+	fillRectVGradient(-_originx,-_originy,_width,_height,color1,color2);
 }
 
 // fillScreenHGradient - fills screen with horizontal gradient
 void ILI9341_t3::fillScreenHGradient(uint16_t color1, uint16_t color2)
 {
-	fillRectHGradient(0,0,_width,_height,color1,color2);
+	fillRectHGradient(-_originx,-_originy,_width,_height,color1,color2);
+}
+
+
+ILI9341_t3 * volatile ILI9341_t3::_busOwner[ILI9341_SPI_BUSES];
+
+#ifdef ILI9341_T3_USE_DMA
+ILI9341_t3 *ILI9341_t3::_dmaActiveDisplay[ILI9341_SPI_BUSES];
+
+// One handler per SPI bus, so displays on different buses can update at
+// the same time
+void ILI9341_t3::dmaInterrupt(void)
+{
+	if (_dmaActiveDisplay[0]) _dmaActiveDisplay[0]->process_dma_interrupt();
+}
+#if ILI9341_SPI_BUSES > 1
+void ILI9341_t3::dmaInterrupt1(void)
+{
+	if (_dmaActiveDisplay[1]) _dmaActiveDisplay[1]->process_dma_interrupt();
+}
+void ILI9341_t3::dmaInterrupt2(void)
+{
+	if (_dmaActiveDisplay[2]) _dmaActiveDisplay[2]->process_dma_interrupt();
+}
+#endif
+
+void ILI9341_t3::attachDMAInterrupt(void)
+{
+	switch (_spi_num) {
+#if ILI9341_SPI_BUSES > 1
+	case 1: _dmatx->attachInterrupt(dmaInterrupt1); break;
+	case 2: _dmatx->attachInterrupt(dmaInterrupt2); break;
+#endif
+	default: _dmatx->attachInterrupt(dmaInterrupt); break;
+	}
+}
+
+// The channel is only taken once asynchronous drawing is first used, so
+// displays that never use it don't hold one
+bool ILI9341_t3::allocDMAChannel(void)
+{
+	if (!_dmatx) _dmatx = new DMAChannel();
+	if (!_dmatx) return false;
+	_dmatx->begin(false);	// tries again if no channel was free before
+	return _dmatx->channel < DMA_NUM_CHANNELS;
+}
+
+// Without DMA the transfer is done before returning, with the same
+// transaction slicing as fillRect
+bool ILI9341_t3::sendNow(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	uint32_t slice = rowsPerTransaction(w, h);
+	beginSPITransaction(_clock);
+	beginWrite(x, y, x+w-1, y+h-1);
+	while (1) {
+		uint32_t rows = (slice < (uint32_t)h) ? slice : h;
+		if (_dma_src) {
+			writePixels_last(_dma_src, rows * w);
+			_dma_src += rows * w;
+		} else {
+			writeColor_last(_dma_color, rows * w);
+		}
+		h -= rows;
+		if (h <= 0) break;
+		endSPITransaction();
+		beginSPITransaction(_clock);
+	}
+	endSPITransaction();
+	if (_dma_callback) (*_dma_callback)(this);
+	return true;
+}
+
+#if defined(KINETISK)
+bool ILI9341_t3::initDMA(void)
+{
+	// the PUSHR buffer is only needed, and only allocated, once async
+	// drawing is used
+	if (!_dma_pushr) _dma_pushr = (uint32_t *)malloc(2 * ILI9341_DMA_PUSHR_COUNT * 4);
+	if (!_dma_pushr || !allocDMAChannel()) return false;
+	switch (_spi_num) {
+#if defined(__MK64FX512__)
+	// T3.5 has one request for both directions of SPI1 and SPI2
+	case 1: _dmatx->triggerAtHardwareEvent(DMAMUX_SOURCE_SPI1); break;
+	case 2: _dmatx->triggerAtHardwareEvent(DMAMUX_SOURCE_SPI2); break;
+#elif ILI9341_SPI_BUSES > 1
+	case 1: _dmatx->triggerAtHardwareEvent(DMAMUX_SOURCE_SPI1_TX); break;
+	case 2: _dmatx->triggerAtHardwareEvent(DMAMUX_SOURCE_SPI2_TX); break;
+#endif
+	default: _dmatx->triggerAtHardwareEvent(DMAMUX_SOURCE_SPI0_TX); break;
+	}
+	attachDMAInterrupt();
+	for (uint8_t i = 0; i < 2; i++) {
+		_dmasettings[i].sourceBuffer(_dma_pushr + i * ILI9341_DMA_PUSHR_COUNT, ILI9341_DMA_PUSHR_COUNT * 4);
+		_dmasettings[i].destination(_pkinetisk_spi->PUSHR);
+		_dmasettings[i].replaceSettingsOnCompletion(_dmasettings[i ^ 1]);
+		_dmasettings[i].interruptAtCompletion();
+	}
+	_dma_state |= ILI9341_DMA_INIT;
+	return true;
+}
+
+// Build the PUSHR words for the next row of pixels into one half of the
+// ping-pong buffer.  The final word of the transfer carries EOQ instead of
+// CONT, exactly like writedata16_last(), and stops the DMA.
+void ILI9341_t3::fillPushrBuffer(uint8_t i)
+{
+	uint32_t count = _dma_remaining;
+	if (count > ILI9341_DMA_PUSHR_COUNT) count = ILI9341_DMA_PUSHR_COUNT;
+	uint32_t *p = _dma_pushr + i * ILI9341_DMA_PUSHR_COUNT;
+	uint32_t cont = (pcs_data << 16) | SPI_PUSHR_CTAS(1) | SPI_PUSHR_CONT;
+	if (_dma_src) {
+		for (uint32_t n = count; n > 0; n--) *p++ = *_dma_src++ | cont;
+	} else {
+		uint32_t word = _dma_color | cont;
+		for (uint32_t n = count; n > 0; n--) *p++ = word;
+	}
+	_dma_remaining -= count;
+
+	DMASetting &setting = _dmasettings[i];
+	setting.sourceBuffer(_dma_pushr + i * ILI9341_DMA_PUSHR_COUNT, count * 4);
+	if (_dma_remaining == 0) {
+		p[-1] = (p[-1] & ~SPI_PUSHR_CONT) | SPI_PUSHR_EOQ;
+		setting.disableOnCompletion();
+	} else {
+		setting.TCD->CSR &= ~DMA_TCD_CSR_DREQ;
+	}
+	_dma_pending++;
+}
+
+bool ILI9341_t3::startAsync(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (!(_dma_state & ILI9341_DMA_INIT) && !initDMA()) return sendNow(x, y, w, h);
+	// the bus interrupt goes to one display, queue behind another's transfer
+	ILI9341_t3 *active = _dmaActiveDisplay[_spi_num];
+	if (active && (active != this)) active->waitAsyncComplete();
+
+	beginSPITransaction(_clock);
+	beginWrite(x, y, x+w-1, y+h-1);
+
+	_dma_remaining = (uint32_t)w * h;
+	_dma_pending = 0;
+	_dma_mcr = _pkinetisk_spi->MCR;
+	fillPushrBuffer(0);
+	if (_dma_remaining) fillPushrBuffer(1);
+	_dma_buffer = 0;
+	*_dmatx = _dmasettings[0];
+
+	_dma_state |= ILI9341_DMA_ACTIVE;
+	_dmaActiveDisplay[_spi_num] = this;
+	_pkinetisk_spi->RSER = SPI_RSER_TFFF_RE | SPI_RSER_TFFF_DIRS;
+	_dmatx->enable();
+	return true;
+}
+
+void ILI9341_t3::process_dma_interrupt(void)
+{
+	_dmatx->clearInterrupt();
+	// The half that just went out can take the next row
+	if (--_dma_pending) {
+		if (_dma_remaining) fillPushrBuffer(_dma_buffer);
+		_dma_buffer ^= 1;
+		return;
+	}
+	// Last word carried EOQ, same as waitTransmitComplete(mcr)
+	while (!(_pkinetisk_spi->SR & SPI_SR_EOQF)) ;
+	_pkinetisk_spi->SR = SPI_SR_EOQF;
+	_pkinetisk_spi->RSER = 0;
+	_pkinetisk_spi->MCR = _dma_mcr | SPI_MCR_CLR_RXF;	// discard what came back
+	endSPITransaction();
+
+	_dmaActiveDisplay[_spi_num] = NULL;
+	_dma_state &= ~ILI9341_DMA_ACTIVE;
+	if (_dma_callback) (*_dma_callback)(this);
+}
+
+#else  // Teensy 4.x
+bool ILI9341_t3::initDMA(void)
+{
+	if (!allocDMAChannel()) return false;
+	_dmatx->destination((volatile uint16_t &)_pimxrt_spi->TDR);
+	switch (_spi_num) {
+	case 1: _dmatx->triggerAtHardwareEvent(DMAMUX_SOURCE_LPSPI3_TX); break;
+	case 2: _dmatx->triggerAtHardwareEvent(DMAMUX_SOURCE_LPSPI1_TX); break;
+	default: _dmatx->triggerAtHardwareEvent(DMAMUX_SOURCE_LPSPI4_TX); break;
+	}
+	_dmatx->disableOnCompletion();
+	_dmatx->interruptAtCompletion();
+	attachDMAInterrupt();
+	_dma_state |= ILI9341_DMA_INIT;
+	return true;
+}
+
+// Hand the next (at most ILI9341_DMA_MAX_COUNT pixel) piece to the DMA
+void ILI9341_t3::startDMAChunk(void)
+{
+	uint32_t count = _dma_remaining;
+	if (count > ILI9341_DMA_MAX_COUNT) count = ILI9341_DMA_MAX_COUNT;
+	if (_dma_src) {
+		_dmatx->sourceBuffer(_dma_src, count * 2);
+		_dma_src += count;
+	} else {
+		_dmatx->source(_dma_color);
+		_dmatx->transferCount(count);
+	}
+	_dma_remaining -= count;
+	_dmatx->enable();
+}
+
+bool ILI9341_t3::startAsync(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (!(_dma_state & ILI9341_DMA_INIT) && !initDMA()) return sendNow(x, y, w, h);
+	// the bus interrupt goes to one display, queue behind another's transfer
+	ILI9341_t3 *active = _dmaActiveDisplay[_spi_num];
+	if (active && (active != this)) active->waitAsyncComplete();
+
+	beginSPITransaction(_clock);
+	beginWrite(x, y, x+w-1, y+h-1);
+	// RX is masked so the DMA never has to drain the receive FIFO
+	maybeUpdateTCR(_tcr_dc_not_assert | LPSPI_TCR_FRAMESZ(15) | LPSPI_TCR_RXMSK);
+
+	_dma_remaining = (uint32_t)w * h;
+	_dma_state |= ILI9341_DMA_ACTIVE;
+	_dmaActiveDisplay[_spi_num] = this;
+	startDMAChunk();
+	_pimxrt_spi->DER = LPSPI_DER_TDDE;
+	return true;
+}
+
+void ILI9341_t3::process_dma_interrupt(void)
+{
+	_dmatx->clearInterrupt();
+	if (_dma_remaining) {
+		startDMAChunk();
+		return;
+	}
+	// Everything is in the FIFO, wait for it to go out on the wire
+	while (_pimxrt_spi->FSR & 0x1f) ;
+	while (_pimxrt_spi->SR & LPSPI_SR_MBF) ;
+	_pimxrt_spi->DER = 0;
+	_pimxrt_spi->CR = LPSPI_CR_MEN | LPSPI_CR_RRF;	// Clear RX FIFO
+	_pimxrt_spi->SR = 0x3f00;	// clear status flags
+	_pending_rx_count = 0;
+	maybeUpdateTCR(_tcr_dc_not_assert | LPSPI_TCR_FRAMESZ(7));
+	endSPITransaction();
+
+	_dmaActiveDisplay[_spi_num] = NULL;
+	_dma_state &= ~ILI9341_DMA_ACTIVE;
+	if (_dma_callback) (*_dma_callback)(this);
+}
+#endif
+
+bool ILI9341_t3::fillRectAsync(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+	// same clipping as fillRect
+	x += _originx;
+	y += _originy;
+	if((x >= _clipx2) || (y >= _clipy2)) return false;
+	if(x < _clipx1) {	w += x - _clipx1; x = _clipx1; 	}
+	if(y < _clipy1) {	h += y - _clipy1; y = _clipy1; 	}
+	if((x + w) > _clipx2)  w = _clipx2  - x;
+	if((y + h) > _clipy2) h = _clipy2 - y;
+	if((w <= 0) || (h <= 0)) return false;
+	if (_use_fbtft) {
+		fbFillRect(x, y, w, h, color);
+		if (_dma_callback) (*_dma_callback)(this);
+		return true;
+	}
+
+	waitAsyncComplete();
+	_dma_src = NULL;
+	_dma_color = color;
+	return startAsync(x, y, w, h);
+}
+
+bool ILI9341_t3::writeRectAsync(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors)
+{
+	if((w <= 0) || (h <= 0) || clipReject(x, y, w, h)) return false;
+	if (_use_fbtft || (x + _originx < _clipx1) || (y + _originy < _clipy1) ||
+			(x + _originx + w > _clipx2) || (y + _originy + h > _clipy2)) {
+		// DMA needs the pixels in one piece, clipped blocks are written now
+		writeRect(x, y, w, h, pcolors);
+		if (_dma_callback) (*_dma_callback)(this);
+		return true;
+	}
+	x += _originx;
+	y += _originy;
+
+	waitAsyncComplete();
+#if defined(__IMXRT1052__) || defined(__IMXRT1062__)
+	// DMAMEM and malloc memory is cached, make sure the DMA sees the pixels
+	if ((uint32_t)pcolors >= 0x20200000u) arm_dcache_flush((void *)pcolors, (uint32_t)w * h * 2);
+#endif
+	_dma_src = pcolors;
+	return startAsync(x, y, w, h);
+}
+
+// DMA needs the pixels in one piece, so send whole rows from the first to
+// the last changed row of tiles
+bool ILI9341_t3::updateScreenAsync(void)
+{
+	if (!_use_fbtft || _fb_banded || _dl_recording) return false;
+	if (_fb_bits != 16) {
+		// indices have to be expanded by the CPU a row at a time anyway
+		updateScreen();
+		if (_dma_callback) (*_dma_callback)(this);
+		return true;
+	}
+	fbDiffDirty();
+	const int16_t tile_rows = (_height + ILI9341_TILE_SIZE - 1) >> ILI9341_TILE_SHIFT;
+	int16_t r0 = 0, r1 = tile_rows - 1;
+	while ((r0 < tile_rows) && !_fb_dirty[r0]) r0++;
+	if (r0 == tile_rows) return false;	// nothing changed
+	while (!_fb_dirty[r1]) r1--;
+	memset(_fb_dirty, 0, sizeof(_fb_dirty));
+
+	int16_t y = r0 << ILI9341_TILE_SHIFT;
+	int16_t h = ((r1 + 1) << ILI9341_TILE_SHIFT) - y;
+	if ((y + h) > _height) h = _height - y;
+	_stats.fb_bytes_sent += (uint32_t)_width * h * 2;
+	_stats.fb_bytes_avoided += (uint32_t)_width * (_height - h) * 2;
+
+	waitAsyncComplete();
+	waitScanLine(y, h);
+#if defined(__IMXRT1052__) || defined(__IMXRT1062__)
+	arm_dcache_flush(_pfbtft + y * _width, (uint32_t)_width * h * 2);
+#endif
+	_dma_src = _pfbtft + y * _width;
+	return startAsync(0, y, _width, h);
+}
+
+#else
+// No DMA support, just do the work now
+
+bool ILI9341_t3::fillRectAsync(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+	fillRect(x, y, w, h, color);
+	if (_dma_callback) (*_dma_callback)(this);
+	return true;
+}
+
+bool ILI9341_t3::writeRectAsync(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors)
+{
+	writeRect(x, y, w, h, pcolors);
+	if (_dma_callback) (*_dma_callback)(this);
+	return true;
+}
+
+bool ILI9341_t3::updateScreenAsync(void)
+{
+	if (!_use_fbtft || _fb_banded || _dl_recording) return false;
+	updateScreen();
+	if (_dma_callback) (*_dma_callback)(this);
+	return true;
+}
+#endif
+
+bool ILI9341_t3::useFrameBuffer(bool use, uint8_t bits)
+{
+	if ((bits != 16) && (bits != 8) && (bits != 4)) return false;
+	waitAsyncComplete();
+	if (use && _pfbtft && (bits != _fb_bits)) {
+		// a different depth needs a buffer of a different size
+		_use_fbtft = 0;
+		free(_pfbtft);
+		_pfbtft = NULL;
+	}
+	if (use && !_pfbtft) {
+		const uint32_t size = ((uint32_t)ILI9341_TFTWIDTH * ILI9341_TFTHEIGHT * bits) >> 3;
+		_pfbtft = (uint16_t *)malloc(size);
+		if (!_pfbtft) return false;
+		memset(_pfbtft, 0, size);
+		_fb_bits = bits;
+	}
+	if (use && !_use_fbtft) {
+		// the screen doesn't show what is in the buffer yet
+		memset(_fb_dirty, 0, sizeof(_fb_dirty));
+		fbMarkDirty(0, 0, _width, _height);
+		_fb_hash_valid = false;
+	}
+	_fb_y0 = 0;
+	_fb_y1 = _height;
+	_use_fbtft = use;
+	return true;
+}
+
+void ILI9341_t3::setPalette(const uint16_t *palette)
+{
+	_fb_palette = palette;
+	// the indices haven't changed, the colors they stand for have
+	memset(_fb_dirty, 0, sizeof(_fb_dirty));
+	fbMarkDirty(0, 0, _width, _height);
+	_fb_hash_valid = false;
+}
+
+void ILI9341_t3::freeFrameBuffer(void)
+{
+	waitAsyncComplete();
+	_use_fbtft = 0;
+	free(_pfbtft);
+	_pfbtft = NULL;
+	setFrameDiff(false);
+}
+
+bool ILI9341_t3::setFrameDiff(bool diff)
+{
+	if (!diff) {
+		free(_fb_hash);
+		_fb_hash = NULL;
+		return true;
+	}
+	if (!_fb_hash) {
+		// tile columns never outnumber the tile rows of the long side
+		_fb_hash = (uint32_t *)malloc(ILI9341_TILE_ROWS * ILI9341_TILE_ROWS * sizeof(uint32_t));
+		if (!_fb_hash) return false;
+		_fb_hash_valid = false;
+	}
+	return true;
+}
+
+// Multiply-rotate hash (the xxHash32 round) of one tile, four bytes at a
+// time.  Tiles start on a 16 pixel boundary, so rows are word aligned at
+// every depth.
+uint32_t ILI9341_t3::fbHashTile(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	uint32_t hash = 0x165667B1;
+	const uint32_t stride = ((uint32_t)_width * _fb_bits) >> 3;
+	const uint32_t bytes = ((uint32_t)w * _fb_bits + 7) >> 3;
+	const uint8_t *row = (const uint8_t *)_pfbtft + y * stride + (((uint32_t)x * _fb_bits) >> 3);
+	for (; h > 0; h--, row += stride) {
+		uint32_t i = 0;
+		for (; i + 4 <= bytes; i += 4) {
+			hash += *(const uint32_t *)(row + i) * 0x85EBCA77;
+			hash = ((hash << 13) | (hash >> 19)) * 0x9E3779B1;
+		}
+		if (i < bytes) {
+			uint32_t v = 0;
+			memcpy(&v, row + i, bytes - i);
+			hash += v * 0x85EBCA77;
+			hash = ((hash << 13) | (hash >> 19)) * 0x9E3779B1;
+		}
+	}
+	return hash;
+}
+
+// Indexed framebuffer access.  Rows are _width * _fb_bits / 8 bytes, with
+// 4 bit pixels packed high nibble first.  Coordinates are already clipped.
+void ILI9341_t3::fbIndexedFill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t index)
+{
+	const uint32_t stride = ((uint32_t)_width * _fb_bits) >> 3;
+	uint8_t *row = (uint8_t *)_pfbtft + (y - _fb_y0) * stride;
+	for (; h > 0; h--, row += stride) {
+		if (_fb_bits == 8) {
+			memset(row + x, index, w);
+			continue;
+		}
+		int16_t i = x, end = x + w;
+		if (i & 1) {
+			row[i >> 1] = (row[i >> 1] & 0xf0) | (index & 0x0f);
+			i++;
+		}
+		if (end - i >= 2) {
+			memset(row + (i >> 1), (index & 0x0f) * 0x11, (end - i) >> 1);
+			i += (end - i) & ~1;
+		}
+		if (i < end) row[i >> 1] = (row[i >> 1] & 0x0f) | (index << 4);
+	}
+}
+
+void ILI9341_t3::fbIndexedStore(int16_t x, int16_t y, const uint16_t *indices, int16_t n)
+{
+	uint8_t *row = (uint8_t *)_pfbtft + (y - _fb_y0) * (((uint32_t)_width * _fb_bits) >> 3);
+	if (_fb_bits == 8) {
+		for (int16_t j = 0; j < n; j++) row[x + j] = indices[j];
+		return;
+	}
+	for (int16_t j = 0; j < n; j++) {
+		uint8_t *p = row + ((x + j) >> 1);
+		if ((x + j) & 1) {
+			*p = (*p & 0xf0) | (indices[j] & 0x0f);
+		} else {
+			*p = (*p & 0x0f) | (indices[j] << 4);
+		}
+	}
+}
+
+uint16_t ILI9341_t3::fbIndexedLoad(int16_t x, int16_t y)
+{
+	const uint8_t *row = (const uint8_t *)_pfbtft + (y - _fb_y0) * (((uint32_t)_width * _fb_bits) >> 3);
+	if (_fb_bits == 8) return row[x];
+	return (row[x >> 1] >> ((x & 1) ? 0 : 4)) & 0x0f;
+}
+
+// Clear the dirty bit of tiles that hash the same as when they were last
+// sent.  Until the hashes are known to match the screen, every tile is
+// hashed and nothing is dropped.
+void ILI9341_t3::fbDiffDirty(void)
+{
+	if (!_fb_hash) return;
+	const int16_t tile_rows = (_height + ILI9341_TILE_SIZE - 1) >> ILI9341_TILE_SHIFT;
+	const int16_t tile_cols = (_width + ILI9341_TILE_SIZE - 1) >> ILI9341_TILE_SHIFT;
+
+	for (int16_t r = 0; r < tile_rows; r++) {
+		if (_fb_hash_valid && !_fb_dirty[r]) continue;
+		int16_t y = r << ILI9341_TILE_SHIFT;
+		int16_t h = ((y + ILI9341_TILE_SIZE) > _height) ? _height - y : ILI9341_TILE_SIZE;
+		uint32_t *stored = _fb_hash + r * ILI9341_TILE_ROWS;
+		for (int16_t c = 0; c < tile_cols; c++) {
+			uint32_t bit = 1u << c;
+			if (_fb_hash_valid && !(_fb_dirty[r] & bit)) continue;
+			int16_t x = c << ILI9341_TILE_SHIFT;
+			int16_t w = ((x + ILI9341_TILE_SIZE) > _width) ? _width - x : ILI9341_TILE_SIZE;
+			uint32_t hash = fbHashTile(x, y, w, h);
+			if (_fb_hash_valid && (stored[c] == hash)) _fb_dirty[r] &= ~bit;
+			stored[c] = hash;
+		}
+	}
+	_fb_hash_valid = true;
+}
+
+void ILI9341_t3::markDirty(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if(x < 0) {	w += x; x = 0; 	}
+	if(y < 0) {	h += y; y = 0; 	}
+	if((x + w) > _width)  w = _width  - x;
+	if((y + h) > _height) h = _height - y;
+	if((w <= 0) || (h <= 0)) return;
+	fbMarkDirty(x, y, w, h);
+}
+
+// Send one window of the framebuffer, sliced into transactions the same
+// way as fillRect
+void ILI9341_t3::fbUpdateRect(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (_fb_bits != 16) {
+		const uint32_t stride = ((uint32_t)_width * _fb_bits) >> 3;
+		if (!_fb_palette) return;
+		sendPaletted(x, y, w, h, (const uint8_t *)_pfbtft + (y - _fb_y0) * stride, stride, x, _fb_palette, _fb_bits);
+		return;
+	}
+	const uint16_t *pcolors = _pfbtft + (y - _fb_y0) * _width + x;
+	uint32_t slice = rowsPerTransaction(w, h), rows = slice;
+
+	beginSPITransaction(_clock);
+	beginWrite(x, y, x+w-1, y+h-1);
+	for (; h > 0; h--) {
+		if (h > 1 && --rows) {
+			writePixels_cont(pcolors, w);
+		} else {
+			writePixels_last(pcolors, w);
+			if (h > 1) {
+				endSPITransaction();
+				beginSPITransaction(_clock);
+				rows = slice;
+			}
+		}
+		pcolors += _width;
+	}
+	endSPITransaction();
+}
+
+// Send the changed tiles.  Each run of dirty tiles in a row of tiles is
+// grown downwards for as long as the rows below have the same tiles
+// dirty, and goes out as one address window.
+void ILI9341_t3::updateScreen(void)
+{
+	if (!_use_fbtft || _fb_banded || _dl_recording) return;
+	fbDiffDirty();
+	const int16_t tile_rows = (_height + ILI9341_TILE_SIZE - 1) >> ILI9341_TILE_SHIFT;
+	uint32_t sent = 0;
+
+	for (int16_t r0 = 0; r0 < tile_rows; r0++) {
+		while (_fb_dirty[r0]) {
+			uint8_t c0 = __builtin_ctz(_fb_dirty[r0]);
+			uint8_t len = __builtin_ctz(~(_fb_dirty[r0] >> c0));
+			uint32_t mask = ((1u << len) - 1) << c0;
+			int16_t r1 = r0;
+			while ((r1 + 1 < tile_rows) && ((_fb_dirty[r1 + 1] & mask) == mask)) r1++;
+			for (int16_t r = r0; r <= r1; r++) _fb_dirty[r] &= ~mask;
+
+			int16_t x = c0 << ILI9341_TILE_SHIFT;
+			int16_t y = r0 << ILI9341_TILE_SHIFT;
+			int16_t w = len << ILI9341_TILE_SHIFT;
+			int16_t h = (r1 - r0 + 1) << ILI9341_TILE_SHIFT;
+			if ((x + w) > _width)  w = _width  - x;
+			if ((y + h) > _height) h = _height - y;
+			fbUpdateRect(x, y, w, h);
+			sent += (uint32_t)w * h;
+		}
+	}
+	_stats.fb_bytes_sent += sent * 2;
+	_stats.fb_bytes_avoided += ((uint32_t)_width * _height - sent) * 2;
+}
+
+ILI9341_t3_dlcmd_t *ILI9341_t3::dlAdd(uint8_t op, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+	if ((op == ILI9341_DL_FILL) && _dl_count) {
+		// grow the last fill when this one carries on from it
+		ILI9341_t3_dlcmd_t *prev = &_dl_list[_dl_count - 1];
+		if ((prev->op == ILI9341_DL_FILL) && (prev->color == color)) {
+			if ((prev->x == x) && (prev->w == w) && (prev->y + prev->h == y)) {
+				prev->h += h;
+				return prev;
+			}
+			if ((prev->y == y) && (prev->h == h) && (prev->x + prev->w == x)) {
+				prev->w += w;
+				return prev;
+			}
+		}
+	}
+	if (_dl_count >= _dl_size) {
+		_stats.dl_overflows++;
+		return NULL;
+	}
+	ILI9341_t3_dlcmd_t *cmd = &_dl_list[_dl_count++];
+	cmd->op = op;
+	cmd->x = x;
+	cmd->y = y;
+	cmd->w = w;
+	cmd->h = h;
+	cmd->color = color;
+	return cmd;
+}
+
+// Run recorded operations through the normal drawing functions, so they
+// end up wherever drawing currently goes.  Coordinates were recorded
+// relative to the screen, so the origin has to be 0.
+void ILI9341_t3::dlReplay(const ILI9341_t3_dlcmd_t *cmd, uint16_t count)
+{
+	uint16_t color = textcolor;
+	for (; count > 0; count--, cmd++) {
+		switch (cmd->op) {
+		case ILI9341_DL_FILL:
+			fillRect(cmd->x, cmd->y, cmd->w, cmd->h, cmd->color);
+			break;
+		case ILI9341_DL_VGRADIENT:
+			fillRectVGradient(cmd->x, cmd->y, cmd->w, cmd->h, cmd->color, cmd->color2);
+			break;
+		case ILI9341_DL_HGRADIENT:
+			fillRectHGradient(cmd->x, cmd->y, cmd->w, cmd->h, cmd->color, cmd->color2);
+			break;
+		case ILI9341_DL_WRITE:
+			writeRect(cmd->x, cmd->y, cmd->w, cmd->h, (const uint16_t *)cmd->pixels);
+			break;
+		case ILI9341_DL_PALETTED:
+			writeRectPaletted(cmd->x, cmd->y, cmd->w, cmd->h, (const uint8_t *)cmd->pixels, cmd->palette, cmd->arg);
+			break;
+		case ILI9341_DL_CHAR:
+			drawChar(cmd->x, cmd->y, cmd->arg, cmd->color, cmd->color2, cmd->w);
+			break;
+		case ILI9341_DL_FONTBITS:
+			textcolor = cmd->color;
+			drawFontBits(cmd->bits, cmd->arg, cmd->x, cmd->y, cmd->h);
+			break;
+		case ILI9341_DL_CLIP:
+			setClipScreen(cmd->x, cmd->y, cmd->x + cmd->w, cmd->y + cmd->h);
+			break;
+		}
+	}
+	textcolor = color;
+}
+
+bool ILI9341_t3::useBands(uint16_t rows, uint16_t commands)
+{
+#ifdef ILI9341_T3_USE_DMA
+	const uint32_t strips = 2;	// render one band while the other goes out
+#else
+	const uint32_t strips = 1;
+#endif
+	freeBands();
+	_band_buf = (uint16_t *)malloc(strips * rows * ILI9341_TFTHEIGHT * 2);
+	_dl_list = (ILI9341_t3_dlcmd_t *)malloc(commands * sizeof(ILI9341_t3_dlcmd_t));
+	if (!_band_buf || !_dl_list) {
+		freeBands();
+		return false;
+	}
+	_band_rows = rows;
+	_dl_size = commands;
+	return true;
+}
+
+void ILI9341_t3::freeBands(void)
+{
+	waitAsyncComplete();
+	free(_band_buf);
+	free(_dl_list);
+	_band_buf = NULL;
+	_dl_list = NULL;
+	_band_rows = 0;
+	_dl_size = 0;
+}
+
+bool ILI9341_t3::beginFrame(uint16_t bgcolor)
+{
+	if (!_band_rows || _use_fbtft) return false;
+	waitAsyncComplete();
+	_band_bg = bgcolor;
+	_band_saved_fb = _pfbtft;
+	_band_saved_bits = _fb_bits;
+	_pfbtft = _band_buf;
+	_fb_bits = 16;
+	_fb_y0 = 0;
+	_fb_y1 = _height;
+	_dl_count = 0;
+	_dl_recording = true;
+	_fb_banded = true;
+	_use_fbtft = 1;
+	// every band starts out with the clip rectangle the frame started with
+	dlAdd(ILI9341_DL_CLIP, _clipx1, _clipy1, _clipx2 - _clipx1, _clipy2 - _clipy1, 0);
+	return true;
+}
+
+void ILI9341_t3::endFrame(void)
+{
+	if (!_fb_banded) return;
+	_dl_recording = false;
+	const ILI9341_t3_view_t view = { _originx, _originy, _clipx1, _clipy1, _clipx2, _clipy2 };
+	_originx = 0;
+	_originy = 0;
+#ifdef ILI9341_T3_USE_DMA
+	ILI9341_t3_callback callback = _dma_callback;
+	uint8_t strip = 0;
+	_dma_callback = NULL;	// the caller only sees one synchronous frame
+#endif
+	for (int16_t y = 0; y < _height; y += _band_rows) {
+		int16_t h = ((y + _band_rows) > _height) ? _height - y : _band_rows;
+#ifdef ILI9341_T3_USE_DMA
+		_pfbtft = _band_buf + strip * _band_rows * ILI9341_TFTHEIGHT;
+#endif
+		_fb_y0 = y;
+		_fb_y1 = y + h;
+		uint16_t *p = _pfbtft;
+		for (uint32_t n = (uint32_t)_width * h; n > 0; n--) *p++ = _band_bg;
+		dlReplay(_dl_list, _dl_count);
+#ifdef ILI9341_T3_USE_DMA
+		// the previous band has to finish before this one can start
+		waitAsyncComplete();
+		waitScanLine(y, h);
+#if defined(__IMXRT1052__) || defined(__IMXRT1062__)
+		if ((uint32_t)_pfbtft >= 0x20200000u) arm_dcache_flush(_pfbtft, (uint32_t)_width * h * 2);
+#endif
+		_dma_src = _pfbtft;
+		startAsync(0, y, _width, h);
+		strip ^= 1;
+#else
+		waitScanLine(y, h);
+		fbUpdateRect(0, y, _width, h);
+#endif
+	}
+#ifdef ILI9341_T3_USE_DMA
+	waitAsyncComplete();
+	_dma_callback = callback;
+#endif
+	_use_fbtft = 0;
+	_fb_banded = false;
+	_pfbtft = _band_saved_fb;
+	_fb_bits = _band_saved_bits;
+	_originx = view.originx;
+	_originy = view.originy;
+	setClipScreen(view.clipx1, view.clipy1, view.clipx2, view.clipy2);
+}
+
+void ILI9341_t3::setSpriteBackground(const uint16_t *pixels, uint16_t color)
+{
+	_sprite_bg = pixels;
+	_sprite_bg_color = color;
+	_sprite_x1 = 0;
+	_sprite_y1 = 0;
+	_sprite_x2 = _width;
+	_sprite_y2 = _height;
+}
+
+void ILI9341_t3::addSprite(ILI9341_t3_sprite_t *sprite)
+{
+	sprite->drawn = false;
+	sprite->dirty = true;
+	sprite->next = _sprites;
+	_sprites = sprite;
+}
+
+void ILI9341_t3::removeSprite(ILI9341_t3_sprite_t *sprite)
+{
+	for (ILI9341_t3_sprite_t **link = &_sprites; *link; link = &(*link)->next) {
+		if (*link != sprite) continue;
+		*link = sprite->next;
+		if (!sprite->drawn) return;
+		// the next update has to put back what it covered
+		int16_t x2 = sprite->drawn_x + sprite->drawn_w, y2 = sprite->drawn_y + sprite->drawn_h;
+		if (_sprite_x1 >= _sprite_x2) {
+			_sprite_x1 = sprite->drawn_x;
+			_sprite_y1 = sprite->drawn_y;
+			_sprite_x2 = x2;
+			_sprite_y2 = y2;
+		} else {
+			if (sprite->drawn_x < _sprite_x1) _sprite_x1 = sprite->drawn_x;
+			if (sprite->drawn_y < _sprite_y1) _sprite_y1 = sprite->drawn_y;
+			if (x2 > _sprite_x2) _sprite_x2 = x2;
+			if (y2 > _sprite_y2) _sprite_y2 = y2;
+		}
+		return;
+	}
+}
+
+typedef struct {
+	int16_t x1, y1, x2, y2;
+} sprite_box_t;
+
+// Add a box to the list, clipped to the clip rectangle and merged with
+// any box it overlaps.  When the list is full it is merged with the last
+// one.
+static uint8_t addSpriteBox(sprite_box_t *boxes, uint8_t count, sprite_box_t box, const sprite_box_t &clip)
+{
+	if (box.x1 < clip.x1) box.x1 = clip.x1;
+	if (box.y1 < clip.y1) box.y1 = clip.y1;
+	if (box.x2 > clip.x2) box.x2 = clip.x2;
+	if (box.y2 > clip.y2) box.y2 = clip.y2;
+	if ((box.x1 >= box.x2) || (box.y1 >= box.y2)) return count;
+	for (uint8_t i = 0; i < count; ) {
+		if ((box.x1 < boxes[i].x2) && (boxes[i].x1 < box.x2) &&
+				(box.y1 < boxes[i].y2) && (boxes[i].y1 < box.y2)) {
+			// the union may overlap boxes already checked, start over
+			if (boxes[i].x1 < box.x1) box.x1 = boxes[i].x1;
+			if (boxes[i].y1 < box.y1) box.y1 = boxes[i].y1;
+			if (boxes[i].x2 > box.x2) box.x2 = boxes[i].x2;
+			if (boxes[i].y2 > box.y2) box.y2 = boxes[i].y2;
+			boxes[i] = boxes[--count];
+			i = 0;
+			continue;
+		}
+		i++;
+	}
+	if (count == ILI9341_SPRITE_BOXES) {
+		sprite_box_t *last = &boxes[count - 1];
+		if (last->x1 < box.x1) box.x1 = last->x1;
+		if (last->y1 < box.y1) box.y1 = last->y1;
+		if (last->x2 > box.x2) box.x2 = last->x2;
+		if (last->y2 > box.y2) box.y2 = last->y2;
+		count--;
+	}
+	boxes[count++] = box;
+	return count;
+}
+
+// Build one scanline of a box: the background, then every sprite that
+// crosses it, lowest z first
+void ILI9341_t3::composeSpriteRow(uint16_t *line, int16_t x, int16_t w, int16_t y)
+{
+	if (_sprite_bg) {
+		memcpy(line, _sprite_bg + y * _width + x, w * 2);
+	} else {
+		for (int16_t i = 0; i < w; i++) line[i] = _sprite_bg_color;
+	}
+	for (const ILI9341_t3_sprite_t *s = _sprites; s; s = s->next) {
+		if (!s->visible || (y < s->y) || (y >= s->y + s->h)) continue;
+		int16_t i0 = (s->x > x) ? s->x : x;
+		int16_t i1 = ((s->x + s->w) < (x + w)) ? s->x + s->w : x + w;
+		if (i0 >= i1) continue;
+		const int16_t sy = y - s->y;
+		const uint8_t *mask = s->mask ? s->mask + sy * ((s->w + 7) >> 3) : NULL;
+		for (int16_t i = i0; i < i1; i++) {
+			const int16_t sx = i - s->x;
+			if (mask && !(mask[sx >> 3] & (0x80 >> (sx & 7)))) continue;
+			uint16_t color;
+			if (s->palette) {
+				uint8_t index = ((const uint8_t *)s->pixels)[sy * s->w + sx];
+				if (s->keyed && (index == s->key)) continue;
+				color = s->palette[index];
+			} else {
+				color = ((const uint16_t *)s->pixels)[sy * s->w + sx];
+				if (s->keyed && (color == s->key)) continue;
+			}
+			line[i - x] = color;
+		}
+	}
+}
+
+// Compose and send a box as one window, sliced into transactions the same
+// way as fillRect
+void ILI9341_t3::sendSpriteBox(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	uint16_t line[ILI9341_LINE_PIXELS];
+
+	if (_use_fbtft) {
+		for (; h > 0; h--, y++) {
+			composeSpriteRow(line, x, w, y);
+			fbWriteRect(x, y, w, 1, line);
+		}
+		return;
+	}
+	uint32_t slice = rowsPerTransaction(w, h), rows = slice;
+	beginSPITransaction(_clock);
+	beginWrite(x, y, x+w-1, y+h-1);
+	for (; h > 0; h--, y++) {
+		composeSpriteRow(line, x, w, y);
+		if (h > 1 && --rows) {
+			writePixels_cont(line, w);
+		} else {
+			writePixels_last(line, w);
+			if (h > 1) {
+				endSPITransaction();
+				beginSPITransaction(_clock);
+				rows = slice;
+			}
+		}
+	}
+	endSPITransaction();
+}
+
+void ILI9341_t3::updateSprites(void)
+{
+	if (_fb_banded || _dl_recording) return;	// the line buffer can't be recorded
+	sprite_box_t boxes[ILI9341_SPRITE_BOXES];
+	const sprite_box_t clip = { _clipx1, _clipy1, _clipx2, _clipy2 };
+	uint8_t count = 0;
+
+	// keep the list in z order, sketches may change z at any time
+	ILI9341_t3_sprite_t *sorted = NULL;
+	while (_sprites) {
+		ILI9341_t3_sprite_t *s = _sprites;
+		_sprites = s->next;
+		ILI9341_t3_sprite_t **link = &sorted;
+		while (*link && ((*link)->z <= s->z)) link = &(*link)->next;
+		s->next = *link;
+		*link = s;
+	}
+	_sprites = sorted;
+
+	if (_sprite_x1 < _sprite_x2) {
+		count = addSpriteBox(boxes, count, (sprite_box_t){ _sprite_x1, _sprite_y1, _sprite_x2, _sprite_y2 }, clip);
+		_sprite_x1 = _sprite_x2 = 0;
+	}
+	for (ILI9341_t3_sprite_t *s = _sprites; s; s = s->next) {
+		bool changed = s->dirty || (s->visible != s->drawn) ||
+			(s->visible && ((s->x != s->drawn_x) || (s->y != s->drawn_y) ||
+				(s->w != s->drawn_w) || (s->h != s->drawn_h) ||
+				(s->z != s->drawn_z) || (s->pixels != s->drawn_pixels)));
+		if (!changed) continue;
+		if (s->drawn) {
+			count = addSpriteBox(boxes, count, (sprite_box_t){ s->drawn_x, s->drawn_y,
+				(int16_t)(s->drawn_x + s->drawn_w), (int16_t)(s->drawn_y + s->drawn_h) }, clip);
+		}
+		if (s->visible) {
+			count = addSpriteBox(boxes, count, (sprite_box_t){ s->x, s->y,
+				(int16_t)(s->x + s->w), (int16_t)(s->y + s->h) }, clip);
+		}
+		s->drawn = s->visible;
+		s->drawn_x = s->x;
+		s->drawn_y = s->y;
+		s->drawn_w = s->w;
+		s->drawn_h = s->h;
+		s->drawn_z = s->z;
+		s->drawn_pixels = s->pixels;
+		s->dirty = false;
+	}
+	for (uint8_t i = 0; i < count; i++) {
+		sendSpriteBox(boxes[i].x1, boxes[i].y1, boxes[i].x2 - boxes[i].x1, boxes[i].y2 - boxes[i].y1);
+	}
+}
+
+int8_t ILI9341_t3::captureUnder(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (_dl_recording) return -1;	// nothing drawn yet to read back
+	// keep only what the clip shows, readRect() zero fills the rest and
+	// restoreUnder() would write that back under a wider clip
+	int16_t x1 = max((int16_t)(x + _originx), _clipx1);
+	int16_t y1 = max((int16_t)(y + _originy), _clipy1);
+	int16_t x2 = min((int16_t)(x + _originx + w), _clipx2);
+	int16_t y2 = min((int16_t)(y + _originy + h), _clipy2);
+	if ((x1 >= x2) || (y1 >= y2)) return -1;
+	w = x2 - x1;
+	h = y2 - y1;
+	if (!_use_fbtft && (_miso == 0xff)) return -1;	// can't read the display
+	ILI9341_t3_under_t *under = NULL;
+	for (uint8_t i = 0; i < ILI9341_UNDER_SLOTS; i++) {
+		if (!_under[i].seq) {
+			under = &_under[i];
+			break;
+		}
+	}
+	if (!under) return -1;
+	const uint32_t count = (uint32_t)w * h;
+	if (count > under->size) {
+		free(under->pixels);
+		under->pixels = (uint16_t *)malloc(count * 2);
+		under->size = under->pixels ? count : 0;
+		if (!under->pixels) return -1;
+	}
+	readRect(x1 - _originx, y1 - _originy, w, h, under->pixels);
+	under->x = x1;
+	under->y = y1;
+	under->w = w;
+	under->h = h;
+	if (!++_under_seq) _under_seq = 1;
+	under->seq = _under_seq;
+	return under - _under;
+}
+
+void ILI9341_t3::restoreUnder(int8_t slot)
+{
+	if (slot < 0) {
+		// the newest capture still held
+		for (uint8_t i = 0; i < ILI9341_UNDER_SLOTS; i++) {
+			if (_under[i].seq && ((slot < 0) || ((int16_t)(_under[i].seq - _under[slot].seq) > 0))) slot = i;
+		}
+		if (slot < 0) return;
+	}
+	if ((slot >= ILI9341_UNDER_SLOTS) || !_under[slot].seq) return;
+	ILI9341_t3_under_t *under = &_under[slot];
+	writeRect(under->x - _originx, under->y - _originy, under->w, under->h, under->pixels);
+	under->seq = 0;
+}
+
+void ILI9341_t3::freeUnder(void)
+{
+	for (uint8_t i = 0; i < ILI9341_UNDER_SLOTS; i++) {
+		free(_under[i].pixels);
+		_under[i].pixels = NULL;
+		_under[i].size = 0;
+		_under[i].seq = 0;
+	}
+}
+
+bool ILI9341_t3::beginRecord(ILI9341_t3_dlcmd_t *list, uint16_t size)
+{
+	if (_dl_recording || _fb_banded || !size) return false;
+	waitAsyncComplete();
+	_rec_saved_list = _dl_list;
+	_rec_saved_size = _dl_size;
+	_rec_saved_use_fb = _use_fbtft;
+	_rec_overflows = _stats.dl_overflows;
+	_dl_list = list;
+	_dl_size = size;
+	_dl_count = 0;
+	_dl_retained = true;
+	_dl_recording = true;
+	_use_fbtft = 1;		// the fb helpers do the recording
+	_fb_y0 = 0;
+	_fb_y1 = _height;
+	dlAdd(ILI9341_DL_CLIP, _clipx1, _clipy1, _clipx2 - _clipx1, _clipy2 - _clipy1, 0);
+	return true;
+}
+
+uint16_t ILI9341_t3::endRecord(void)
+{
+	if (!_dl_retained) return 0;
+	uint16_t count = (_stats.dl_overflows == _rec_overflows) ? _dl_count : 0;
+	_dl_recording = false;
+	_dl_retained = false;
+	_dl_list = _rec_saved_list;
+	_dl_size = _rec_saved_size;
+	_dl_count = 0;
+	_use_fbtft = _rec_saved_use_fb;
+	return count;
+}
+
+// Fills were clipped when they were recorded, so they go straight to the
+// wire, sharing transactions up to the budget.  Everything else runs
+// through the drawing functions.
+void ILI9341_t3::replay(const ILI9341_t3_dlcmd_t *list, uint16_t count)
+{
+	if (_dl_recording || _fb_banded) return;
+	const ILI9341_t3_view_t view = { _originx, _originy, _clipx1, _clipy1, _clipx2, _clipy2 };
+	_originx = 0;
+	_originy = 0;
+	if (_use_fbtft) {
+		dlReplay(list, count);
+	} else {
+		const uint32_t budget = _transaction_budget ? rowsPerTransaction(1, 1) : 0xFFFFFFFF;
+		uint32_t pixels = 0;
+		bool open = false;
+		waitAsyncComplete();
+		for (; count > 0; count--, list++) {
+			if (list->op != ILI9341_DL_FILL) {
+				if (open) {
+					writecommand_last(ILI9341_NOP);
+					endSPITransaction();
+					open = false;
+				}
+				dlReplay(list, 1);
+				continue;
+			}
+			uint32_t n = (uint32_t)list->w * list->h;
+			if (open && (pixels + n > budget)) {
+				writecommand_last(ILI9341_NOP);
+				endSPITransaction();
+				open = false;
+			}
+			if (!open) {
+				beginSPITransaction(_clock);
+				open = true;
+				pixels = 0;
+			}
+			beginWrite(list->x, list->y, list->x + list->w - 1, list->y + list->h - 1);
+			writeColor_cont(list->color, n);
+			pixels += n;
+		}
+		if (open) {
+			writecommand_last(ILI9341_NOP);
+			endSPITransaction();
+		}
+	}
+	_originx = view.originx;
+	_originy = view.originy;
+	setClipScreen(view.clipx1, view.clipy1, view.clipx2, view.clipy2);
+}
+
+bool ILI9341_t3::setTearPacing(bool pace)
+{
+#if defined(__IMXRT1062__)
+	if (pace && ((_miso == 0xff) || !_dcport)) return false;
+	_tear_pacing = pace;
+	return true;
+#else
+	return !pace;
+#endif
+}
+
+// Wait until the refresh is in the top half of the rows about to be
+// sent.  When the band goes out within one refresh, the refresh can't
+// lap the writes from there.  A longer band is lapped wherever it starts,
+// so don't spend the wait on it.
+void ILI9341_t3::waitScanLine(int16_t y, int16_t h)
+{
+	if (!_tear_pacing || (rotation != 0)) return;
+	if ((uint64_t)_width * h * 16 * 1000000 > (uint64_t)_clock * ILI9341_REFRESH_US) return;
+	uint32_t start = micros();
+	while ((micros() - start) < ILI9341_REFRESH_US) {	// a whole refresh, the panel isn't answering
+		uint16_t line = readScanLine();
+		if ((line >= y) && (line < y + (h + 1) / 2)) break;
+	}
 }
 
 
@@ -274,6 +1476,7 @@ void ILI9341_t3::fillScreenHGradient(uint16_t color1, uint16_t color2)
 void ILI9341_t3::setRotation(uint8_t m)
 {
 	rotation = m % 4; // can't be higher than 3
+	_gram_valid = false;
 	beginSPITransaction(_clock);
 	writecommand_cont(ILI9341_MADCTL);
 	switch (rotation) {
@@ -299,10 +1502,66 @@ void ILI9341_t3::setRotation(uint8_t m)
 		break;
 	}
 	endSPITransaction();
+	if (_use_fbtft) {
+		// the tiles are laid out differently now, just send everything
+		_fb_y1 = _height;
+		memset(_fb_dirty, 0, sizeof(_fb_dirty));
+		fbMarkDirty(0, 0, _width, _height);
+		_fb_hash_valid = false;
+	}
+	setClipScreen(0, 0, _width, _height);
 	cursor_x = 0;
 	cursor_y = 0;
 }
 
+// Limit drawing to a rectangle of the screen, recorded in the display
+// list when building a banded frame
+void ILI9341_t3::setClipScreen(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+	if (x1 < 0) x1 = 0;
+	if (y1 < 0) y1 = 0;
+	if (x2 > _width)  x2 = _width;
+	if (y2 > _height) y2 = _height;
+	if (x2 < x1) x2 = x1;
+	if (y2 < y1) y2 = y1;
+	_clipx1 = x1;
+	_clipy1 = y1;
+	_clipx2 = x2;
+	_clipy2 = y2;
+	if (_dl_recording) dlAdd(ILI9341_DL_CLIP, x1, y1, x2 - x1, y2 - y1, 0);
+}
+
+void ILI9341_t3::setClipRect(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	x += _originx;
+	y += _originy;
+	setClipScreen(x, y, x + w, y + h);
+}
+
+bool ILI9341_t3::pushOrigin(int16_t dx, int16_t dy)
+{
+	if (_view_depth >= ILI9341_ORIGIN_DEPTH) return false;
+	ILI9341_t3_view_t *view = &_view_stack[_view_depth++];
+	view->originx = _originx;
+	view->originy = _originy;
+	view->clipx1 = _clipx1;
+	view->clipy1 = _clipy1;
+	view->clipx2 = _clipx2;
+	view->clipy2 = _clipy2;
+	_originx += dx;
+	_originy += dy;
+	return true;
+}
+
+void ILI9341_t3::popOrigin(void)
+{
+	if (!_view_depth) return;
+	const ILI9341_t3_view_t *view = &_view_stack[--_view_depth];
+	_originx = view->originx;
+	_originy = view->originy;
+	setClipScreen(view->clipx1, view->clipy1, view->clipx2, view->clipy2);
+}
+
 void ILI9341_t3::setBGR(bool b) {
     madctl_bgr = b ? MADCTL_BGR : MADCTL_RGB;
 }
@@ -350,18 +1609,18 @@ uint8_t ILI9341_t3::readdata(void)
        // Try to work directly with SPI registers...
        // First wait until output queue is empty
         uint16_t wTimeout = 0xffff;
-        while (((KINETISK_SPI0.SR) & (15 << 12)) && (--wTimeout)) ; // wait until empty
+        while (((_pkinetisk_spi->SR) & (15 << 12)) && (--wTimeout)) ; // wait until empty
         
-//       	KINETISK_SPI0.MCR |= SPI_MCR_CLR_RXF; // discard any received data
-//		KINETISK_SPI0.SR = SPI_SR_TCF;
+//       	_pkinetisk_spi->MCR |= SPI_MCR_CLR_RXF; // discard any received data
+//		_pkinetisk_spi->SR = SPI_SR_TCF;
         
         // Transfer a 0 out... 
         writedata8_cont(0);   
         
         // Now wait until completed. 
         wTimeout = 0xffff;
-        while (((KINETISK_SPI0.SR) & (15 << 12)) && (--wTimeout)) ; // wait until empty
-        r = KINETISK_SPI0.POPR;  // get the received byte... should check for it first...
+        while (((_pkinetisk_spi->SR) & (15 << 12)) && (--wTimeout)) ; // wait until empty
+        r = _pkinetisk_spi->POPR;  // get the received byte... should check for it first...
     return r;
 }
  */
@@ -377,48 +1636,32 @@ uint8_t ILI9341_t3::readcommand8(uint8_t c, uint8_t index)
     uint8_t r=0;
 
     beginSPITransaction(_clock);
-    while (((KINETISK_SPI0.SR) & (15 << 12)) && (--wTimeout)) ; // wait until empty
+    while (((_pkinetisk_spi->SR) & (15 << 12)) && (--wTimeout)) ; // wait until empty
 
     // Make sure the last frame has been sent...
-    KINETISK_SPI0.SR = SPI_SR_TCF;   // dlear it out;
+    _pkinetisk_spi->SR = SPI_SR_TCF;   // dlear it out;
     wTimeout = 0xffff;
-    while (!((KINETISK_SPI0.SR) & SPI_SR_TCF) && (--wTimeout)) ; // wait until it says the last frame completed
+    while (!((_pkinetisk_spi->SR) & SPI_SR_TCF) && (--wTimeout)) ; // wait until it says the last frame completed
 
     // clear out any current received bytes
     wTimeout = 0x10;    // should not go more than 4...
-    while ((((KINETISK_SPI0.SR) >> 4) & 0xf) && (--wTimeout))  {
-        r = KINETISK_SPI0.POPR;
+    while ((((_pkinetisk_spi->SR) >> 4) & 0xf) && (--wTimeout))  {
+        r = _pkinetisk_spi->POPR;
     }
 
-    //writecommand(0xD9); // sekret command
-	KINETISK_SPI0.PUSHR = 0xD9 | (pcs_command << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_CONT;
-//	while (((KINETISK_SPI0.SR) & (15 << 12)) > (3 << 12)) ; // wait if FIFO full
-
-    // writedata(0x10 + index);
-	KINETISK_SPI0.PUSHR = (0x10 + index) | (pcs_data << 16) | SPI_PUSHR_CTAS(0);
-//	while (((KINETISK_SPI0.SR) & (15 << 12)) > (3 << 12)) ; // wait if FIFO full
-
-    // writecommand(c);
-   	KINETISK_SPI0.PUSHR = c | (pcs_command << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_CONT;
-//	while (((KINETISK_SPI0.SR) & (15 << 12)) > (3 << 12)) ; // wait if FIFO full
-
-    // readdata
-	KINETISK_SPI0.PUSHR = 0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0);
-//	while (((KINETISK_SPI0.SR) & (15 << 12)) > (3 << 12)) ; // wait if FIFO full
-
-    // Now wait until completed.
-    wTimeout = 0xffff;
-    while (((KINETISK_SPI0.SR) & (15 << 12)) && (--wTimeout)) ; // wait until empty
-
-    // Make sure the last frame has been sent...
-    KINETISK_SPI0.SR = SPI_SR_TCF;   // dlear it out;
-    wTimeout = 0xffff;
-    while (!((KINETISK_SPI0.SR) & SPI_SR_TCF) && (--wTimeout)) ; // wait until it says the last frame completed
-
-    wTimeout = 0x10;    // should not go more than 4...
-    // lets get all of the values on the FIFO
-    while ((((KINETISK_SPI0.SR) >> 4) & 0xf) && (--wTimeout))  {
-        r = KINETISK_SPI0.POPR;
+    // Send one frame at a time and pop what comes back, so this also works
+    // on the buses with a one entry FIFO
+    const uint32_t pushr[4] = {
+        0xD9 | (pcs_command << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_CONT,  // sekret command
+        (uint32_t)(0x10 + index) | (pcs_data << 16) | SPI_PUSHR_CTAS(0),
+        c | (pcs_command << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_CONT,
+        (uint32_t)0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0)                // readdata
+    };
+    for (uint8_t i = 0; i < 4; i++) {
+        _pkinetisk_spi->PUSHR = pushr[i];
+        wTimeout = 0xffff;
+        while (!(((_pkinetisk_spi->SR) >> 4) & 0xf) && (--wTimeout)) ; // wait for the frame to come back
+        r = _pkinetisk_spi->POPR;
     }
     endSPITransaction();
     return r;  // get the received byte... should check for it first...
@@ -431,33 +1674,33 @@ uint8_t ILI9341_t3::readcommand8(uint8_t c, uint8_t index)
 	//delayMicroseconds(10);
 	//digitalWriteFast(2, LOW);
 
-	beginSPITransaction(ILI9341_SPICLOCK_READ);
+	beginSPITransaction(_clock_read);
 
 	if (_dcport) {
 		// DC pin is controlled by GPIO
 		DIRECT_WRITE_LOW(_dcport, _dcpinmask);
-		IMXRT_LPSPI4_S.SR = LPSPI_SR_TCF | LPSPI_SR_FCF | LPSPI_SR_WCF;
-		IMXRT_LPSPI4_S.TCR = LPSPI_TCR_FRAMESZ(7) | LPSPI_TCR_RXMSK | LPSPI_TCR_CONT;
-		IMXRT_LPSPI4_S.TDR = 0xD9;
-		while (!(IMXRT_LPSPI4_S.SR & LPSPI_SR_WCF)) ; // wait until word complete
+		_pimxrt_spi->SR = LPSPI_SR_TCF | LPSPI_SR_FCF | LPSPI_SR_WCF;
+		_pimxrt_spi->TCR = LPSPI_TCR_FRAMESZ(7) | LPSPI_TCR_RXMSK | LPSPI_TCR_CONT;
+		_pimxrt_spi->TDR = 0xD9;
+		while (!(_pimxrt_spi->SR & LPSPI_SR_WCF)) ; // wait until word complete
 
 		DIRECT_WRITE_HIGH(_dcport, _dcpinmask);
-		IMXRT_LPSPI4_S.SR = LPSPI_SR_TCF | LPSPI_SR_FCF | LPSPI_SR_WCF;
-		IMXRT_LPSPI4_S.TDR = 0x10 + index;
-		while (!(IMXRT_LPSPI4_S.SR & LPSPI_SR_WCF)) ; // wait until word complete
+		_pimxrt_spi->SR = LPSPI_SR_TCF | LPSPI_SR_FCF | LPSPI_SR_WCF;
+		_pimxrt_spi->TDR = 0x10 + index;
+		while (!(_pimxrt_spi->SR & LPSPI_SR_WCF)) ; // wait until word complete
 
 		DIRECT_WRITE_LOW(_dcport, _dcpinmask);
-		IMXRT_LPSPI4_S.SR = LPSPI_SR_TCF | LPSPI_SR_FCF | LPSPI_SR_WCF;
-		IMXRT_LPSPI4_S.TDR = c;
-		while (!(IMXRT_LPSPI4_S.SR & LPSPI_SR_WCF)) ; // wait until word complete
+		_pimxrt_spi->SR = LPSPI_SR_TCF | LPSPI_SR_FCF | LPSPI_SR_WCF;
+		_pimxrt_spi->TDR = c;
+		while (!(_pimxrt_spi->SR & LPSPI_SR_WCF)) ; // wait until word complete
 
 		DIRECT_WRITE_HIGH(_dcport, _dcpinmask);
-		IMXRT_LPSPI4_S.SR = LPSPI_SR_TCF | LPSPI_SR_FCF | LPSPI_SR_WCF;
-		IMXRT_LPSPI4_S.TCR = LPSPI_TCR_FRAMESZ(7);
-		IMXRT_LPSPI4_S.TDR = 0x10 + index;
-		while (!(IMXRT_LPSPI4_S.SR & LPSPI_SR_WCF)) ; // wait until word complete
-		while (((IMXRT_LPSPI4_S.FSR >> 16) & 0x1F) == 0) ; // wait until rx fifo not empty
-		r = IMXRT_LPSPI4_S.RDR;
+		_pimxrt_spi->SR = LPSPI_SR_TCF | LPSPI_SR_FCF | LPSPI_SR_WCF;
+		_pimxrt_spi->TCR = LPSPI_TCR_FRAMESZ(7);
+		_pimxrt_spi->TDR = 0x10 + index;
+		while (!(_pimxrt_spi->SR & LPSPI_SR_WCF)) ; // wait until word complete
+		while (((_pimxrt_spi->FSR >> 16) & 0x1F) == 0) ; // wait until rx fifo not empty
+		r = _pimxrt_spi->RDR;
 	} else {
 		// DC pin is controlled by SPI CS hardware
 
@@ -492,22 +1735,23 @@ uint16_t ILI9341_t3::readScanLine()
 	//digitalWriteFast(2, HIGH); // oscilloscope trigger for testing
 	//delayMicroseconds(10);
 	//digitalWriteFast(2, LOW);
-	beginSPITransaction(ILI9341_SPICLOCK_READ);
+	beginSPITransaction(_clock_read);
 	if (_dcport) {
 		// DC pin is controlled by GPIO
 		DIRECT_WRITE_LOW(_dcport, _dcpinmask);
-		IMXRT_LPSPI4_S.SR = LPSPI_SR_TCF | LPSPI_SR_FCF | LPSPI_SR_WCF;
-		IMXRT_LPSPI4_S.TCR = LPSPI_TCR_FRAMESZ(7) | LPSPI_TCR_RXMSK | LPSPI_TCR_CONT;
-		IMXRT_LPSPI4_S.TDR = 0x45;
-		while (!(IMXRT_LPSPI4_S.SR & LPSPI_SR_WCF)) ; // wait until word complete
+		_pimxrt_spi->SR = LPSPI_SR_TCF | LPSPI_SR_FCF | LPSPI_SR_WCF;
+		_pimxrt_spi->TCR = LPSPI_TCR_FRAMESZ(7) | LPSPI_TCR_RXMSK | LPSPI_TCR_CONT;
+		_pimxrt_spi->TDR = 0x45;
+		while (!(_pimxrt_spi->SR & LPSPI_SR_WCF)) ; // wait until word complete
 		DIRECT_WRITE_HIGH(_dcport, _dcpinmask);
-		IMXRT_LPSPI4_S.TDR = 0;
-		IMXRT_LPSPI4_S.TCR = LPSPI_TCR_FRAMESZ(15);
-		IMXRT_LPSPI4_S.TDR = 0;
-		while (!(IMXRT_LPSPI4_S.SR & LPSPI_SR_WCF)) ; // wait until word complete
-		while (((IMXRT_LPSPI4_S.FSR >> 16) & 0x1F) == 0) ; // wait until rx fifo not empty
-		line = IMXRT_LPSPI4_S.RDR >> 7;
-		//if (IMXRT_LPSPI4_S.FSR != 0) Serial.println("ERROR: junk remains in FIFO!!!");
+		_pimxrt_spi->TDR = 0;
+		_pimxrt_spi->TCR = LPSPI_TCR_FRAMESZ(15);
+		_pimxrt_spi->TDR = 0;
+		while (!(_pimxrt_spi->SR & LPSPI_SR_WCF)) ; // wait until word complete
+		while (((_pimxrt_spi->FSR >> 16) & 0x1F) == 0) ; // wait until rx fifo not empty
+		line = _pimxrt_spi->RDR >> 7;
+		//if (_pimxrt_spi->FSR != 0) Serial.println("ERROR: junk remains in FIFO!!!");
+		_pimxrt_spi->TCR = _spi_tcr_current;	// back to what maybeUpdateTCR() thinks it is
 	} else {
 		// DC pin is controlled by SPI CS hardware
 		// TODO...
@@ -524,94 +1768,93 @@ uint16_t ILI9341_t3::readScanLine()
 // Read Pixel at x,y and get back 16-bit packed color
 uint16_t ILI9341_t3::readPixel(int16_t x, int16_t y)
 {
-   if (_miso == 0xff) return 0xffff;	// bail if not valid miso
-#ifdef KINETISK	
-	uint8_t dummy __attribute__((unused));
-	uint8_t r,g,b;
-
-	beginSPITransaction(ILI9341_SPICLOCK_READ);
-
-	setAddr(x, y, x, y);
-	writecommand_cont(ILI9341_RAMRD); // read from RAM
-	waitTransmitComplete();
-
-	// Push 4 bytes over SPI
-	KINETISK_SPI0.PUSHR = 0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0)| SPI_PUSHR_CONT;
-	waitFifoEmpty();    // wait for both queues to be empty.
-
-	KINETISK_SPI0.PUSHR = 0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0)| SPI_PUSHR_CONT;
-	KINETISK_SPI0.PUSHR = 0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0)| SPI_PUSHR_CONT;
-	KINETISK_SPI0.PUSHR = 0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0)| SPI_PUSHR_EOQ;
-
-	// Wait for End of Queue
-	while ((KINETISK_SPI0.SR & SPI_SR_EOQF) == 0) ;
-	KINETISK_SPI0.SR = SPI_SR_EOQF;  // make sure it is clear
-
-	// Read Pixel Data
-	dummy = KINETISK_SPI0.POPR;	// Read a DUMMY byte of GRAM
-	r = KINETISK_SPI0.POPR;		// Read a RED byte of GRAM
-	g = KINETISK_SPI0.POPR;		// Read a GREEN byte of GRAM
-	b = KINETISK_SPI0.POPR;		// Read a BLUE byte of GRAM
-
-	endSPITransaction();
-	return color565(r,g,b);
-#else
-	// Kinetisk
+   if (!_use_fbtft && (_miso == 0xff)) return 0xffff;	// bail if not valid miso
 	uint16_t colors = 0;
 	readRect(x, y, 1, 1, &colors);
 	return colors;
-#endif	
 }
 
-// Now lets see if we can read in multiple pixels
+// Now lets see if we can read in multiple pixels.  Pixels outside the
+// clip rectangle are not read and come back as 0.
+void ILI9341_t3::readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors)
+{
+	if((w <= 0) || (h <= 0)) return;
+	x += _originx;
+	y += _originy;
+	int16_t x0 = (x < _clipx1) ? _clipx1 - x : 0, y0 = (y < _clipy1) ? _clipy1 - y : 0;
+	int16_t x1 = ((x + w) > _clipx2) ? _clipx2 - x : w;
+	int16_t y1 = ((y + h) > _clipy2) ? _clipy2 - y : h;
+	if ((x0 == 0) && (y0 == 0) && (x1 == w) && (y1 == h)) {
+		readRectScreen(x, y, w, h, pcolors);
+		return;
+	}
+	memset(pcolors, 0, (uint32_t)w * h * 2);
+	if ((x0 >= x1) || (y0 >= y1)) return;
+	if ((x0 == 0) && (x1 == w)) {
+		readRectScreen(x, y + y0, w, y1 - y0, pcolors + y0 * w);
+		return;
+	}
+	// the rows are not next to each other in pcolors, read one at a time
+	for (int16_t j = y0; j < y1; j++) {
+		readRectScreen(x + x0, y + j, x1 - x0, 1, pcolors + j * w + x0);
+	}
+}
+
 #ifdef KINETISK
-void ILI9341_t3::readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors)
+void ILI9341_t3::readRectScreen(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors)
 {
+	if (_use_fbtft) {
+		fbReadRect(x, y, w, h, pcolors);
+		return;
+	}
    if (_miso == 0xff) return;		// bail if not valid miso
 	uint8_t dummy __attribute__((unused));
-	uint8_t r,g,b;
-	uint16_t c = w * h;
+	uint32_t c = w * h;
 
-	beginSPITransaction(ILI9341_SPICLOCK_READ);
+	beginSPITransaction(_clock_read);
 
 	setAddr(x, y, x+w-1, y+h-1);
 	writecommand_cont(ILI9341_RAMRD); // read from RAM
+	_gram_valid = false;	// reading moves the GRAM pointer too
 	waitTransmitComplete();
-	KINETISK_SPI0.PUSHR = 0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0)| SPI_PUSHR_CONT | SPI_PUSHR_EOQ;
-	while ((KINETISK_SPI0.SR & SPI_SR_EOQF) == 0) ;
-	KINETISK_SPI0.SR = SPI_SR_EOQF;  // make sure it is clear
-	while ((KINETISK_SPI0.SR & 0xf0)) {
-		dummy = KINETISK_SPI0.POPR;	// Read a DUMMY byte but only once
+	_pkinetisk_spi->PUSHR = 0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0)| SPI_PUSHR_CONT | SPI_PUSHR_EOQ;
+	while ((_pkinetisk_spi->SR & SPI_SR_EOQF) == 0) ;
+	_pkinetisk_spi->SR = SPI_SR_EOQF;  // make sure it is clear
+	while ((_pkinetisk_spi->SR & 0xf0)) {
+		dummy = _pkinetisk_spi->POPR;	// Read a DUMMY byte but only once
 	}
 	c *= 3; // number of bytes we will transmit to the display
-	while (c--) {
-        	if (c) {
-            		KINETISK_SPI0.PUSHR = 0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0)| SPI_PUSHR_CONT;
-        	} else {
-            		KINETISK_SPI0.PUSHR = 0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0)| SPI_PUSHR_EOQ;
-		}
 
-		// If last byte wait until all have come in...
-		if (c == 0) {
-			while ((KINETISK_SPI0.SR & SPI_SR_EOQF) == 0) ;
-			KINETISK_SPI0.SR = SPI_SR_EOQF;  // make sure it is clear
+	// Never have more frames in flight than the FIFOs can hold, SPI1 and
+	// SPI2 on the T3.5/3.6 only have room for one
+	uint32_t sent = 0, received = 0;
+	uint8_t rgb[3];
+	uint8_t rgb_index = 0;
+	while (received < c) {
+		if ((sent < c) && ((sent - received) < _fifo_depth)) {
+			_pkinetisk_spi->PUSHR = 0 | (pcs_data << 16) | SPI_PUSHR_CTAS(0) |
+				((sent == (uint32_t)(c - 1))? SPI_PUSHR_EOQ : SPI_PUSHR_CONT);
+			sent++;
 		}
-
-		if ((KINETISK_SPI0.SR & 0xf0) >= 0x30) { // do we have at least 3 bytes in queue if so extract...
-			r = KINETISK_SPI0.POPR;		// Read a RED byte of GRAM
-			g = KINETISK_SPI0.POPR;		// Read a GREEN byte of GRAM
-			b = KINETISK_SPI0.POPR;		// Read a BLUE byte of GRAM
-			*pcolors++ = color565(r,g,b);
+		if (_pkinetisk_spi->SR & 0xf0) {
+			rgb[rgb_index++] = _pkinetisk_spi->POPR;
+			received++;
+			if (rgb_index == 3) {
+				*pcolors++ = color565(rgb[0], rgb[1], rgb[2]);
+				rgb_index = 0;
+			}
 		}
-
-		// like waitFiroNotFull but does not pop our return queue
-		while ((KINETISK_SPI0.SR & (15 << 12)) > (3 << 12)) ;
 	}
+	_pkinetisk_spi->SR = SPI_SR_EOQF;  // make sure it is clear
 	endSPITransaction();
 }
 #elif defined(__IMXRT1052__) || defined(__IMXRT1062__)  // Teensy 4.x 
-void ILI9341_t3::readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors)
+void ILI9341_t3::readRectScreen(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors)
 {
+	if (_use_fbtft) {
+		fbReadRect(x, y, w, h, pcolors);
+		return;
+	}
    if (_miso == 0xff) return;		// bail if not valid miso
 
 	uint8_t rgb[3];               // RGB bytes received from the display
@@ -619,10 +1862,11 @@ void ILI9341_t3::readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *
 	uint32_t txCount = w * h * 3; // number of bytes we will transmit to the display
 	uint32_t rxCount = txCount;   // number of bytes we will receive back from the display
 
-	beginSPITransaction(ILI9341_SPICLOCK_READ);
+	beginSPITransaction(_clock_read);
 
 	setAddr(x, y, x+w-1, y+h-1);
 	writecommand_cont(ILI9341_RAMRD); // read from RAM
+	_gram_valid = false;	// reading moves the GRAM pointer too
 
 
 	// transmit a DUMMY byte before the color bytes
@@ -630,20 +1874,20 @@ void ILI9341_t3::readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *
 
 	while (txCount || rxCount) {
 		// transmit another byte if possible
-		if (txCount && (IMXRT_LPSPI4_S.SR & LPSPI_SR_TDF)) {
+		if (txCount && (_pimxrt_spi->SR & LPSPI_SR_TDF)) {
 			txCount--;
 			if (txCount) {
-				IMXRT_LPSPI4_S.TDR = 0;
+				_pimxrt_spi->TDR = 0;
 			} else {
 				maybeUpdateTCR(_tcr_dc_not_assert | LPSPI_TCR_FRAMESZ(7)); // remove the CONTINUE...
-				while ((IMXRT_LPSPI4_S.SR & LPSPI_SR_TDF) == 0) ;		// wait if queue was full
-				IMXRT_LPSPI4_S.TDR = 0;
+				while ((_pimxrt_spi->SR & LPSPI_SR_TDF) == 0) ;		// wait if queue was full
+				_pimxrt_spi->TDR = 0;
 			}
 		}
 
 		// receive another byte if possible, and either skip it or store the color
-		if (rxCount && !(IMXRT_LPSPI4_S.RSR & LPSPI_RSR_RXEMPTY)) {
-			rgb[rgbIdx] = IMXRT_LPSPI4_S.RDR;
+		if (rxCount && !(_pimxrt_spi->RSR & LPSPI_RSR_RXEMPTY)) {
+			rgb[rgbIdx] = _pimxrt_spi->RDR;
 
 			rxCount--;
 			rgbIdx++;
@@ -659,56 +1903,250 @@ void ILI9341_t3::readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *
 }
 
 #endif
+
+// CRC-16/CCITT of a run of pixels, used to compare what was written with
+// what the display hands back
+static uint16_t crc16Pixels(const uint16_t *pcolors, uint16_t count)
+{
+	uint16_t crc = 0xFFFF;
+	while (count--) {
+		uint16_t color = *pcolors++;
+		for (uint8_t i = 0; i < 2; i++) {
+			crc ^= (color & 0xFF) << 8;
+			color >>= 8;
+			for (uint8_t bit = 0; bit < 8; bit++) {
+				crc = (crc & 0x8000)? (crc << 1) ^ 0x1021 : crc << 1;
+			}
+		}
+	}
+	return crc;
+}
+
+// Write a pseudo random pattern at the current write clock and check that
+// the same pixels come back at the current read clock.  The seed changes
+// every pass so a stale pattern left in GRAM can never match.
+bool ILI9341_t3::verifyClock(uint32_t seed)
+{
+	uint16_t pattern[ILI9341_CALIBRATE_PIXELS];
+	uint16_t readback[ILI9341_CALIBRATE_PIXELS];
+
+	for (uint16_t i = 0; i < ILI9341_CALIBRATE_PIXELS; i++) {
+		seed = seed * 1664525 + 1013904223;
+		pattern[i] = seed >> 16;
+	}
+	writeRect(0, 0, ILI9341_CALIBRATE_WIDTH, ILI9341_CALIBRATE_PIXELS / ILI9341_CALIBRATE_WIDTH, pattern);
+	memset(readback, 0, sizeof(readback));
+	readRect(0, 0, ILI9341_CALIBRATE_WIDTH, ILI9341_CALIBRATE_PIXELS / ILI9341_CALIBRATE_WIDTH, readback);
+	return crc16Pixels(pattern, ILI9341_CALIBRATE_PIXELS) == crc16Pixels(readback, ILI9341_CALIBRATE_PIXELS);
+}
+
+// Find the fastest read and write clocks this panel and wiring handle.
+// The read clock is raised first with the writes held at the safe
+// ILI9341_SPICLOCK_READ rate, then the write clock is raised using the
+// calibrated reads to check the result.  Each clock stops at its first
+// failure and is backed off by margin_percent.  The pixels used for the
+// test, in the top left corner, are restored afterwards.
+uint32_t ILI9341_t3::calibrateClock(uint32_t max_clock, uint8_t margin_percent)
+{
+	if (_miso == 0xff) return _clock;	// nothing to check against
+	uint16_t saved[ILI9341_CALIBRATE_PIXELS];
+	uint32_t old_clock = _clock, old_clock_read = _clock_read;
+	uint32_t clock, best;
+	uint8_t use_fbtft = _use_fbtft;
+	const ILI9341_t3_view_t view = { _originx, _originy, _clipx1, _clipy1, _clipx2, _clipy2 };
+
+	_use_fbtft = 0;		// test the wire, not the framebuffer
+	_originx = 0;
+	_originy = 0;
+	setClipScreen(0, 0, _width, _height);
+
+	_clock = ILI9341_SPICLOCK_READ;
+	_clock_read = ILI9341_SPICLOCK_READ;
+	readRect(0, 0, ILI9341_CALIBRATE_WIDTH, ILI9341_CALIBRATE_PIXELS / ILI9341_CALIBRATE_WIDTH, saved);
+	if (!verifyClock(0)) {
+		// does not even work at the safe clock, leave things as they were
+		writeRect(0, 0, ILI9341_CALIBRATE_WIDTH, ILI9341_CALIBRATE_PIXELS / ILI9341_CALIBRATE_WIDTH, saved);
+		_clock = old_clock;
+		_clock_read = old_clock_read;
+		_use_fbtft = use_fbtft;
+		_originx = view.originx;
+		_originy = view.originy;
+		setClipScreen(view.clipx1, view.clipy1, view.clipx2, view.clipy2);
+		return _clock;
+	}
+
+	best = ILI9341_SPICLOCK_READ;
+	for (clock = best + ILI9341_CALIBRATE_STEP; clock <= ILI9341_CALIBRATE_READ_MAX; clock += ILI9341_CALIBRATE_STEP) {
+		_clock_read = clock;
+		if (!verifyClock(clock)) break;
+		best = clock;
+	}
+	clock = best * (100 - margin_percent) / 100;
+	_clock_read = (clock > ILI9341_SPICLOCK_READ)? clock : ILI9341_SPICLOCK_READ;
+
+	best = ILI9341_SPICLOCK_READ;
+	for (clock = best + ILI9341_CALIBRATE_STEP; clock <= max_clock; clock += ILI9341_CALIBRATE_STEP) {
+		_clock = clock;
+		if (!verifyClock(clock)) break;
+		best = clock;
+	}
+	clock = best * (100 - margin_percent) / 100;
+	_clock = (clock > ILI9341_SPICLOCK_READ)? clock : ILI9341_SPICLOCK_READ;
+
+	writeRect(0, 0, ILI9341_CALIBRATE_WIDTH, ILI9341_CALIBRATE_PIXELS / ILI9341_CALIBRATE_WIDTH, saved);
+	_use_fbtft = use_fbtft;
+	_originx = view.originx;
+	_originy = view.originy;
+	setClipScreen(view.clipx1, view.clipy1, view.clipx2, view.clipy2);
+	return _clock;
+}
+
 // Now lets see if we can writemultiple pixels
 void ILI9341_t3::writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors)
 {
+	if((w <= 0) || (h <= 0) || clipReject(x, y, w, h)) return;
+	x += _originx;
+	y += _originy;
+	if (_use_fbtft) {
+		fbWriteRect(x, y, w, h, pcolors);
+		return;
+	}
+	int16_t x0 = (x < _clipx1) ? _clipx1 - x : 0, y0 = (y < _clipy1) ? _clipy1 - y : 0;
+	int16_t x1 = ((x + w) > _clipx2) ? _clipx2 - x : w;
+	int16_t y1 = ((y + h) > _clipy2) ? _clipy2 - y : h;
    	beginSPITransaction(_clock);
-	setAddr(x, y, x+w-1, y+h-1);
-	writecommand_cont(ILI9341_RAMWR);
-	for(y=h; y>0; y--) {
-		for(x=w; x>1; x--) {
-			writedata16_cont(*pcolors++);
+	beginWrite(x + x0, y + y0, x + x1 - 1, y + y1 - 1);
+	if ((x0 == 0) && (x1 == w)) {
+		writePixels_last(pcolors + y0 * w, (uint32_t)w * (y1 - y0));
+	} else {
+		// send the visible part of each row
+		for (int16_t j = y0; j < y1 - 1; j++) {
+			writePixels_cont(pcolors + j * w + x0, x1 - x0);
 		}
-		writedata16_last(*pcolors++);
+		writePixels_last(pcolors + (y1 - 1) * w + x0, x1 - x0);
 	}
 	endSPITransaction();
 }
 
-// writeRect8BPP - 	write 8 bit per pixel paletted bitmap
-//					bitmap data in array at pixels, one byte per pixel
-//					color palette data in array at palette
-void ILI9341_t3::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels, const uint16_t * palette )
+// Expand n pixels of a packed row, starting at pixel first, to 565 colors
+static void convertPalettedRow(uint16_t *line, const uint8_t *row, int16_t first, int16_t n, const uint16_t *palette, uint8_t bits)
+{
+	const uint8_t mask = (1 << bits) - 1;
+	for (int16_t j = 0; j < n; j++) {
+		uint32_t bit = (uint32_t)(first + j) * bits;
+		line[j] = palette[(row[bit >> 3] >> (8 - bits - (bit & 7))) & mask];
+	}
+}
+
+// Common code for the paletted writers.  Each row starts on a byte
+// boundary; pixels are packed most significant bits first.  A row is
+// expanded through the palette into a line buffer, which then goes out
+// by DMA when available and the rows are wide enough to pay for it, or
+// through the same burst kernel as writeRect.
+void ILI9341_t3::writeRectPaletted(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels, const uint16_t * palette, uint8_t bits)
+{
+	if((w <= 0) || (h <= 0) || clipReject(x, y, w, h)) return;
+	const uint32_t rowbytes = ((uint32_t)w * bits + 7) >> 3;
+	x += _originx;
+	y += _originy;
+
+	if (_dl_recording) {
+		ILI9341_t3_dlcmd_t *cmd = dlAdd(ILI9341_DL_PALETTED, x, y, w, h, 0);
+		if (cmd) {
+			cmd->arg = bits;
+			cmd->palette = palette;
+			cmd->pixels = pixels;
+		}
+		return;
+	}
+	int16_t first = (x < _clipx1) ? _clipx1 - x : 0;
+	int16_t last = ((x + w) > _clipx2) ? _clipx2 - x : w;
+	int16_t top = (y < _clipy1) ? _clipy1 - y : 0;
+	int16_t bottom = ((y + h) > _clipy2) ? _clipy2 - y : h;
+	if (_use_fbtft) {
+		// expand straight into the framebuffer, also clipped to the band
+		if (y + top < _fb_y0) top = _fb_y0 - y;
+		if (y + bottom > _fb_y1) bottom = _fb_y1 - y;
+		if ((first >= last) || (top >= bottom)) return;
+		pixels += top * rowbytes;
+		for (int16_t row = top; row < bottom; row++, pixels += rowbytes) {
+			if (_fb_bits == 16) {
+				convertPalettedRow(_pfbtft + (y + row - _fb_y0) * _width + x + first, pixels, first, last - first, palette, bits);
+			} else {
+				// the palette maps to framebuffer indices
+				uint16_t line[ILI9341_LINE_PIXELS];
+				convertPalettedRow(line, pixels, first, last - first, palette, bits);
+				fbIndexedStore(x + first, y + row, line, last - first);
+			}
+		}
+		fbMarkDirty(x + first, y + top, last - first, bottom - top);
+		return;
+	}
+	sendPaletted(x + first, y + top, last - first, bottom - top, pixels + top * rowbytes, rowbytes, first, palette, bits);
+}
+
+// Send paletted rows rowbytes apart to the display, starting at pixel
+// first of each row.  Also used to expand an indexed framebuffer.
+void ILI9341_t3::sendPaletted(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels, uint32_t rowbytes, int16_t first, const uint16_t *palette, uint8_t bits)
 {
+#ifdef ILI9341_T3_USE_DMA
+	if ((w >= ILI9341_PALETTED_DMA_MIN) && (w <= ILI9341_LINE_PIXELS)) {
+		// Two line ping-pong: row N goes out by DMA while row N+1 is
+		// converted into the other buffer.  Waiting for the previous row is
+		// what frees the buffer we convert into next.  The lines are on the
+		// stack, which the T4 data cache doesn't cover.
+		uint16_t lines[2][ILI9341_LINE_PIXELS];
+		ILI9341_t3_callback callback = _dma_callback;
+		uint8_t cur = 0;
+
+		_dma_callback = NULL;	// the caller only sees one synchronous write
+		convertPalettedRow(lines[0], pixels, first, w, palette, bits);
+		for (int16_t row = 0; row < h; row++) {
+			waitAsyncComplete();
+			_dma_src = lines[cur];
+			startAsync(x, y + row, w, 1);
+			pixels += rowbytes;
+			cur ^= 1;
+			if (row + 1 < h) convertPalettedRow(lines[cur], pixels, first, w, palette, bits);
+		}
+		waitAsyncComplete();
+		_dma_callback = callback;
+		return;
+	}
+#endif
+	uint16_t line[ILI9341_LINE_PIXELS];
+
    	beginSPITransaction(_clock);
-	setAddr(x, y, x+w-1, y+h-1);
-	writecommand_cont(ILI9341_RAMWR);
+	beginWrite(x, y, x+w-1, y+h-1);
 	for(y=h; y>0; y--) {
-		for(x=w; x>1; x--) {
-			writedata16_cont(palette[*pixels++]);
+		for (int16_t i = 0; i < w; ) {
+			int16_t n = w - i;
+			if (n > ILI9341_LINE_PIXELS) n = ILI9341_LINE_PIXELS;
+			convertPalettedRow(line, pixels, first + i, n, palette, bits);
+			writePixels_cont(line, n);
+			i += n;
 		}
-		writedata16_last(palette[*pixels++]);
+		pixels += rowbytes;
 	}
+	writecommand_last(ILI9341_NOP);
 	endSPITransaction();
 }
 
+// writeRect8BPP - 	write 8 bit per pixel paletted bitmap
+//					bitmap data in array at pixels, one byte per pixel
+//					color palette data in array at palette
+void ILI9341_t3::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels, const uint16_t * palette )
+{
+	writeRectPaletted(x, y, w, h, pixels, palette, 8);
+}
+
 // writeRect4BPP - 	write 4 bit per pixel paletted bitmap
 //					bitmap data in array at pixels, 4 bits per pixel
 //					color palette data in array at palette
 //					width must be at least 2 pixels
 void ILI9341_t3::writeRect4BPP(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels, const uint16_t * palette )
 {
-   	beginSPITransaction(_clock);
-	setAddr(x, y, x+w-1, y+h-1);
-	writecommand_cont(ILI9341_RAMWR);
-	for(y=h; y>0; y--) {
-		for(x=w; x>2; x-=2) {
-			writedata16_cont(palette[((*pixels)>>4)&0xF]);
-			writedata16_cont(palette[(*pixels++)&0xF]);
-		}
-		writedata16_cont(palette[((*pixels)>>4)&0xF]);
-		writedata16_last(palette[(*pixels++)&0xF]);
-	}
-	endSPITransaction();
+	writeRectPaletted(x, y, w, h, pixels, palette, 4);
 }
 
 // writeRect2BPP - 	write 2 bit per pixel paletted bitmap
@@ -717,23 +2155,7 @@ void ILI9341_t3::writeRect4BPP(int16_t x, int16_t y, int16_t w, int16_t h, const
 //					width must be at least 4 pixels
 void ILI9341_t3::writeRect2BPP(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels, const uint16_t * palette )
 {
-   	beginSPITransaction(_clock);
-	setAddr(x, y, x+w-1, y+h-1);
-	writecommand_cont(ILI9341_RAMWR);
-	for(y=h; y>0; y--) {
-		for(x=w; x>4; x-=4) {
-			//unrolled loop might be faster?
-			writedata16_cont(palette[((*pixels)>>6)&0x3]);
-			writedata16_cont(palette[((*pixels)>>4)&0x3]);
-			writedata16_cont(palette[((*pixels)>>2)&0x3]);
-			writedata16_cont(palette[(*pixels++)&0x3]);
-		}
-		writedata16_cont(palette[((*pixels)>>6)&0x3]);
-		writedata16_cont(palette[((*pixels)>>4)&0x3]);
-		writedata16_cont(palette[((*pixels)>>2)&0x3]);
-		writedata16_last(palette[(*pixels++)&0x3]);
-	}
-	endSPITransaction();
+	writeRectPaletted(x, y, w, h, pixels, palette, 2);
 }
 
 // writeRect1BPP - 	write 1 bit per pixel paletted bitmap
@@ -742,31 +2164,7 @@ void ILI9341_t3::writeRect2BPP(int16_t x, int16_t y, int16_t w, int16_t h, const
 //					width must be at least 8 pixels
 void ILI9341_t3::writeRect1BPP(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels, const uint16_t * palette )
 {
-   	beginSPITransaction(_clock);
-	setAddr(x, y, x+w-1, y+h-1);
-	writecommand_cont(ILI9341_RAMWR);
-	for(y=h; y>0; y--) {
-		for(x=w; x>8; x-=8) {
-			//unrolled loop might be faster?
-			writedata16_cont(palette[((*pixels)>>7)&0x1]);
-			writedata16_cont(palette[((*pixels)>>6)&0x1]);
-			writedata16_cont(palette[((*pixels)>>5)&0x1]);
-			writedata16_cont(palette[((*pixels)>>4)&0x1]);
-			writedata16_cont(palette[((*pixels)>>3)&0x1]);
-			writedata16_cont(palette[((*pixels)>>2)&0x1]);
-			writedata16_cont(palette[((*pixels)>>1)&0x1]);
-			writedata16_cont(palette[(*pixels++)&0x1]);
-		}
-		writedata16_cont(palette[((*pixels)>>7)&0x1]);
-		writedata16_cont(palette[((*pixels)>>6)&0x1]);
-		writedata16_cont(palette[((*pixels)>>5)&0x1]);
-		writedata16_cont(palette[((*pixels)>>4)&0x1]);
-		writedata16_cont(palette[((*pixels)>>3)&0x1]);
-		writedata16_cont(palette[((*pixels)>>2)&0x1]);
-		writedata16_cont(palette[((*pixels)>>1)&0x1]);
-		writedata16_last(palette[(*pixels++)&0x1]);
-	}
-	endSPITransaction();
+	writeRectPaletted(x, y, w, h, pixels, palette, 1);
 }
 
 
@@ -798,42 +2196,47 @@ static const uint8_t init_commands[] = {
 
 void ILI9341_t3::begin(void)
 {
-    // verify SPI pins are valid;
-    #ifdef KINETISK
-    #if defined(__MK64FX512__) || defined(__MK66FX1M0__)
-    // Allow to work with mimimum of MOSI and SCK
-    if ((_mosi == 255 || _mosi == 11 || _mosi == 7 || _mosi == 28)  && (_sclk == 255 || _sclk == 13 || _sclk == 14 || _sclk == 27)) 
-	#else
-    if ((_mosi == 255 || _mosi == 11 || _mosi == 7) && (_sclk == 255 || _sclk == 13 || _sclk == 14)) 
-    #endif	
-    {
-        
-		if (_mosi != 255) SPI.setMOSI(_mosi);
-        if (_sclk != 255) SPI.setSCK(_sclk);
-
-        // Now see if valid MISO
-	    #if defined(__MK64FX512__) || defined(__MK66FX1M0__)
-	    if (_miso == 12 || _miso == 8 || _miso == 39)
-		#else
-	    if (_miso == 12 || _miso == 8)
-	    #endif
-		{	
-        	SPI.setMISO(_miso);
-    	} else {
-			_miso = 0xff;	// set miso to 255 as flag it is bad
-		}
+    // verify SPI pins are valid, and find out which SPI bus they are on
+#ifdef KINETISK
+	if ((_mosi == 255 || SPI.pinIsMOSI(_mosi)) && (_sclk == 255 || SPI.pinIsSCK(_sclk))) {
+		_pspi = &SPI;
+		_spi_num = 0;
+		_pkinetisk_spi = &KINETISK_SPI0;
+		_fifo_depth = 4;
+#if defined(__MK64FX512__) || defined(__MK66FX1M0__)
+	} else if (SPI1.pinIsMOSI(_mosi) && SPI1.pinIsSCK(_sclk)) {
+		_pspi = &SPI1;
+		_spi_num = 1;
+		_pkinetisk_spi = &KINETISK_SPI1;
+		_fifo_depth = 1;
+	} else if (SPI2.pinIsMOSI(_mosi) && SPI2.pinIsSCK(_sclk)) {
+		_pspi = &SPI2;
+		_spi_num = 2;
+		_pkinetisk_spi = &KINETISK_SPI2;
+		_fifo_depth = 1;
+#endif
 	} else {
         return; // not valid pins...
 	}
-	SPI.begin();
-	if (SPI.pinIsChipSelect(_cs, _dc)) {
-		pcs_data = SPI.setCS(_cs);
-		pcs_command = pcs_data | SPI.setCS(_dc);
+	_fifo_full_test = (_fifo_depth - 1) << 12;
+	if (_mosi != 255) _pspi->setMOSI(_mosi);
+	if (_sclk != 255) _pspi->setSCK(_sclk);
+
+	// Now see if valid MISO
+	if (_pspi->pinIsMISO(_miso)) {
+		_pspi->setMISO(_miso);
+	} else {
+		_miso = 0xff;	// set miso to 255 as flag it is bad
+	}
+	_pspi->begin();
+	if (_pspi->pinIsChipSelect(_cs, _dc)) {
+		pcs_data = _pspi->setCS(_cs);
+		pcs_command = pcs_data | _pspi->setCS(_dc);
 	} else {
 		// See if at least DC is on chipselect pin, if so try to limp along...
-		if (SPI.pinIsChipSelect(_dc)) {
+		if (_pspi->pinIsChipSelect(_dc)) {
 			pcs_data = 0;
-			pcs_command = pcs_data | SPI.setCS(_dc);
+			pcs_command = pcs_data | _pspi->setCS(_dc);
 			pinMode(_cs, OUTPUT);
 			_csport    = portOutputRegister(digitalPinToPort(_cs));
 			_cspinmask = digitalPinToBitMask(_cs);
@@ -845,17 +2248,40 @@ void ILI9341_t3::begin(void)
 		}
 	}
 #elif defined(__IMXRT1052__) || defined(__IMXRT1062__)  // Teensy 4.x 
+	if ((_mosi == 255 || SPI.pinIsMOSI(_mosi)) && (_sclk == 255 || SPI.pinIsSCK(_sclk))) {
+		_pspi = &SPI;
+		_spi_num = 0;
+		_pimxrt_spi = &IMXRT_LPSPI4_S;
+	} else if (SPI1.pinIsMOSI(_mosi) && SPI1.pinIsSCK(_sclk)) {
+		_pspi = &SPI1;
+		_spi_num = 1;
+		_pimxrt_spi = &IMXRT_LPSPI3_S;
+	} else if (SPI2.pinIsMOSI(_mosi) && SPI2.pinIsSCK(_sclk)) {
+		_pspi = &SPI2;
+		_spi_num = 2;
+		_pimxrt_spi = &IMXRT_LPSPI1_S;
+	} else {
+		return; // not valid pins...
+	}
+	if (_mosi != 255) _pspi->setMOSI(_mosi);
+	if (_sclk != 255) _pspi->setSCK(_sclk);
+	if (_pspi->pinIsMISO(_miso)) {
+		_pspi->setMISO(_miso);
+	} else {
+		_miso = 0xff;	// set miso to 255 as flag it is bad
+	}
+
 	_pending_rx_count = 0;
-	SPI.begin();
+	_pspi->begin();
 	_csport = portOutputRegister(_cs);
 	_cspinmask = digitalPinToBitMask(_cs);
 	pinMode(_cs, OUTPUT);	
 	DIRECT_WRITE_HIGH(_csport, _cspinmask);
-	_spi_tcr_current = IMXRT_LPSPI4_S.TCR; // get the current TCR value 
+	_spi_tcr_current = _pimxrt_spi->TCR; // get the current TCR value 
 
 	// TODO:  Need to setup DC to actually work.
-	if (SPI.pinIsChipSelect(_dc)) {
-	 	uint8_t dc_cs_index = SPI.setCS(_dc);
+	if (_pspi->pinIsChipSelect(_dc)) {
+	 	uint8_t dc_cs_index = _pspi->setCS(_dc);
 	 	_dcport = 0;
 	 	_dcpinmask = 0;
 	 	dc_cs_index--;	// convert to 0 based
@@ -957,19 +2383,23 @@ extern "C" const unsigned char glcdfont[];
 // Draw a circle outline
 void ILI9341_t3::drawCircle(int16_t x0, int16_t y0, int16_t r,
     uint16_t color) {
+  if ((r < 0) || clipReject(x0-r, y0-r, 2*r+1, 2*r+1)) return;
+  x0 += _originx;
+  y0 += _originy;
   int16_t f = 1 - r;
   int16_t ddF_x = 1;
   int16_t ddF_y = -2 * r;
   int16_t x = 0;
   int16_t y = r;
+  int16_t xs = 0;
 
-  drawPixel(x0  , y0+r, color);
-  drawPixel(x0  , y0-r, color);
-  drawPixel(x0+r, y0  , color);
-  drawPixel(x0-r, y0  , color);
-
+  // the outline points of one octant that share a y are sent as a single
+  // run, mirrored into the other seven octants
+  if (!_use_fbtft) beginSPITransaction(_clock);
   while (x<y) {
     if (f >= 0) {
+      circleRun(x0, y0, xs, x, y, color);
+      xs = x + 1;
       y--;
       ddF_y += 2;
       f += ddF_y;
@@ -977,20 +2407,154 @@ void ILI9341_t3::drawCircle(int16_t x0, int16_t y0, int16_t r,
     x++;
     ddF_x += 2;
     f += ddF_x;
+  }
+  circleRun(x0, y0, xs, x, y, color);
+  if (_use_fbtft) return;
+  writecommand_last(ILI9341_NOP);
+  endSPITransaction();
+}
+
+// Sends the outline points xs..xe at height y of the first octant of a
+// circle centered on x0,y0 in screen coordinates, in all eight octants.
+// The run starting on the axis meets its mirror image and goes out whole.
+void ILI9341_t3::circleRun(int16_t x0, int16_t y0, int16_t xs, int16_t xe, int16_t y, uint16_t color)
+{
+  if (xs == 0) {
+    HLine(x0 - xe, y0 - y, 2*xe + 1, color);
+    HLine(x0 - xe, y0 + y, 2*xe + 1, color);
+    VLine(x0 - y, y0 - xe, 2*xe + 1, color);
+    VLine(x0 + y, y0 - xe, 2*xe + 1, color);
+    return;
+  }
+  int16_t len = xe - xs + 1;
+  HLine(x0 + xs, y0 - y, len, color);
+  HLine(x0 - xe, y0 - y, len, color);
+  HLine(x0 + xs, y0 + y, len, color);
+  HLine(x0 - xe, y0 + y, len, color);
+  VLine(x0 - y, y0 + xs, len, color);
+  VLine(x0 - y, y0 - xe, len, color);
+  VLine(x0 + y, y0 + xs, len, color);
+  VLine(x0 + y, y0 - xe, len, color);
+}
+
+// Blends of color over bg for coverage 0..16 sixteenths
+static void aaShades(uint16_t *shade, uint16_t color, uint16_t bg)
+{
+	int16_t r1, g1, b1, r2, g2, b2;
+	ILI9341_t3::color565toRGB14(bg, r1, g1, b1);
+	ILI9341_t3::color565toRGB14(color, r2, g2, b2);
+	for (int16_t k = 0; k <= 16; k++) {
+		shade[k] = ILI9341_t3::RGB14tocolor565(r1 + (((r2 - r1) * k) >> 4),
+			g1 + (((g2 - g1) * k) >> 4), b1 + (((b2 - b1) * k) >> 4));
+	}
+}
+
+// n pixels of colors along a row from x,y, or down a column when steep,
+// in screen coordinates, clipped and sent as one window.  Reversed, the
+// colors are read from the last one back.
+void ILI9341_t3::aaStrip(bool steep, int16_t x, int16_t y, int16_t n, const uint16_t *colors, bool reverse)
+{
+  int16_t start = steep ? y : x, other = steep ? x : y;
+  int16_t lo = steep ? _clipy1 : _clipx1, hi = steep ? _clipy2 : _clipx2;
+  if (steep ? ((x < _clipx1) || (x >= _clipx2)) : ((y < _clipy1) || (y >= _clipy2))) return;
+  int16_t skip = (start < lo) ? lo - start : 0;
+  int16_t end = (start + n > hi) ? hi - start : n;
+  if (end <= skip) return;
+
+  for (int16_t i = skip; i < end; i++) {
+    uint16_t c = reverse ? colors[n - 1 - i] : colors[i];
+    if (_use_fbtft) {
+      if (steep) fbPixel(other, start + i, c);
+      else fbPixel(start + i, other, c);
+    } else {
+      if (i == skip) {
+        if (steep) beginWrite(other, start + skip, other, start + end - 1);
+        else beginWrite(start + skip, other, start + end - 1, other);
+      }
+      writedata16_cont(c);
+    }
+  }
+}
 
-    drawPixel(x0 + x, y0 + y, color);
-    drawPixel(x0 - x, y0 + y, color);
-    drawPixel(x0 + x, y0 - y, color);
-    drawPixel(x0 - x, y0 - y, color);
-    drawPixel(x0 + y, y0 + x, color);
-    drawPixel(x0 - y, y0 + x, color);
-    drawPixel(x0 + y, y0 - x, color);
-    drawPixel(x0 - y, y0 - x, color);
+// Outline points xs..xe of the first octant, d pixels from the center in
+// screen coordinates, mirrored into all eight octants.  colors holds one
+// shade per point; the mirrored halves run the other way and leave out
+// the point on the axis, so it isn't drawn twice.
+void ILI9341_t3::aaCircleRun(int16_t x0, int16_t y0, int16_t xs, int16_t xe, int16_t d, const uint16_t *colors)
+{
+  const int16_t n = xe - xs + 1, axis = xs ? 0 : 1;
+  aaStrip(false, x0 + xs, y0 - d, n, colors, false);
+  aaStrip(false, x0 + xs, y0 + d, n, colors, false);
+  aaStrip(true, x0 + d, y0 + xs, n, colors, false);
+  aaStrip(true, x0 - d, y0 + xs, n, colors, false);
+  if (n - axis <= 0) return;
+  aaStrip(false, x0 - xe, y0 - d, n - axis, colors + axis, true);
+  aaStrip(false, x0 - xe, y0 + d, n - axis, colors + axis, true);
+  aaStrip(true, x0 + d, y0 - xe, n - axis, colors + axis, true);
+  aaStrip(true, x0 - d, y0 - xe, n - axis, colors + axis, true);
+}
+
+void ILI9341_t3::drawCircleAA(int16_t x0, int16_t y0, int16_t r,
+    uint16_t color, uint16_t bg) {
+  if ((r < 0) || clipReject(x0-r-1, y0-r-1, 2*r+3, 2*r+3)) return;
+  if (r == 0) {
+    drawPixel(x0, y0, color);
+    return;
+  }
+  x0 += _originx;
+  y0 += _originy;
+  uint16_t shade[17], inner[ILI9341_AA_RUN], outer[ILI9341_AA_RUN];
+  aaShades(shade, color, bg);
+  const int32_t rr = (int32_t)r * r;
+  int16_t xs = 0, n = 0, yi = r;
+  int16_t first = -1, last = 0;	// outer points with any coverage
+
+  // walk the first octant until it crosses the diagonal.  The points at
+  // the same whole distance form a run, with the coverage split between
+  // an inner and an outer strip.  The outer strip leaves out points with
+  // no coverage at its ends, so what is underneath stays.
+  if (!_use_fbtft) beginSPITransaction(_clock);
+  for (int16_t x = 0; ; x++) {
+    int32_t q = (int32_t)(sqrtf((float)(rr - (int32_t)x * x) * 256.0f) + 0.5f);
+    if (x > (q >> 4)) break;
+    if (n && ((n == ILI9341_AA_RUN) || ((q >> 4) != yi))) {
+      aaCircleRun(x0, y0, xs, xs + n - 1, yi, inner);
+      if (first >= 0) aaCircleRun(x0, y0, xs + first, xs + last, yi + 1, outer + first);
+      xs = x;
+      n = 0;
+      first = -1;
+    }
+    yi = q >> 4;
+    inner[n] = shade[16 - (q & 15)];
+    outer[n] = shade[q & 15];
+    if (q & 15) {
+      if (first < 0) first = n;
+      last = n;
+    }
+    n++;
   }
+  if (n) {
+    aaCircleRun(x0, y0, xs, xs + n - 1, yi, inner);
+    if (first >= 0) aaCircleRun(x0, y0, xs + first, xs + last, yi + 1, outer + first);
+  }
+  if (_use_fbtft) return;
+  writecommand_last(ILI9341_NOP);
+  endSPITransaction();
 }
 
 void ILI9341_t3::drawCircleHelper( int16_t x0, int16_t y0,
                int16_t r, uint8_t cornername, uint16_t color) {
+  if (clipReject(x0-r, y0-r, 2*r+1, 2*r+1)) return;
+  if (!_use_fbtft) beginSPITransaction(_clock);
+  circleCorners(x0 + _originx, y0 + _originy, r, cornername, color);
+  if (_use_fbtft) return;
+  writecommand_last(ILI9341_NOP);
+  endSPITransaction();
+}
+
+// Quarter circle outlines in screen coordinates, inside the caller's transaction
+void ILI9341_t3::circleCorners( int16_t x0, int16_t y0,
+               int16_t r, uint8_t cornername, uint16_t color) {
   int16_t f     = 1 - r;
   int16_t ddF_x = 1;
   int16_t ddF_y = -2 * r;
@@ -1010,30 +2574,125 @@ void ILI9341_t3::drawCircleHelper( int16_t x0, int16_t y0,
     f     += ddF_x;
     if (f >= 0 || x == y) { // time to draw the new line segment
         if (cornername & 0x4) {
-            drawFastHLine(x0 + xold+1, y0 + y, x-xold, color);
-            drawFastVLine(x0 + y, y0 + xold+1, x-xold, color);
+            HLine(x0 + xold+1, y0 + y, x-xold, color);
+            VLine(x0 + y, y0 + xold+1, x-xold, color);
         }
         if (cornername & 0x2) {
-            drawFastHLine(x0 + xold+1, y0 - y, x-xold, color);
-            drawFastVLine(x0 + y, y0 - x, x-xold, color);
+            HLine(x0 + xold+1, y0 - y, x-xold, color);
+            VLine(x0 + y, y0 - x, x-xold, color);
         }
         if (cornername & 0x8) {
-            drawFastVLine(x0 - y, y0 + xold+1, x-xold, color);
-            drawFastHLine(x0 - x, y0 + y, x-xold, color); 
+            VLine(x0 - y, y0 + xold+1, x-xold, color);
+            HLine(x0 - x, y0 + y, x-xold, color); 
         }
         if (cornername & 0x1) {
-            drawFastVLine(x0 - y, y0 - x, x-xold, color);
-            drawFastHLine(x0 - x, y0 - y, x-xold, color);
+            VLine(x0 - y, y0 - x, x-xold, color);
+            HLine(x0 - x, y0 - y, x-xold, color);
         }
         xold = x;
      } // draw new line segment
   }
 }
 
+// Half heights of the columns 0..r of a circle, the same ones the
+// midpoint walk in fillCircleHelper draws, -1 where it draws nothing
+static void circleSpans(int16_t *hh, int16_t r)
+{
+  int16_t f     = 1 - r;
+  int16_t ddF_x = 1;
+  int16_t ddF_y = -2 * r;
+  int16_t x     = 0;
+  int16_t y     = r;
+
+  for (int16_t i = 1; i <= r; i++) hh[i] = -1;
+  hh[0] = r;
+  while (x<y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f     += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f     += ddF_x;
+
+    if (hh[x] < y) hh[x] = y;
+    if (hh[y] < x) hh[y] = x;
+  }
+}
+
 void ILI9341_t3::fillCircle(int16_t x0, int16_t y0, int16_t r,
 			      uint16_t color) {
-  drawFastVLine(x0, y0-r, 2*r+1, color);
-  fillCircleHelper(x0, y0, r, 3, 0, color);
+  if ((r < 0) || clipReject(x0-r, y0-r, 2*r+1, 2*r+1)) return;
+  if (r > ILI9341_SPAN_RADIUS) {
+    drawFastVLine(x0, y0-r, 2*r+1, color);
+    fillCircleHelper(x0, y0, r, 3, 0, color);
+    return;
+  }
+  int16_t hh[ILI9341_SPAN_RADIUS + 1];
+  circleSpans(hh, r);
+  x0 += _originx;
+  y0 += _originy;
+  fillColumnSpans(x0, x0, y0, y0, hh, r, color);
+}
+
+// Fill an ellipse with radii rx and ry
+void ILI9341_t3::fillEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry,
+			      uint16_t color) {
+  if ((rx < 0) || (ry < 0) || clipReject(x0-rx, y0-ry, 2*rx+1, 2*ry+1)) return;
+  if (rx > ILI9341_SPAN_RADIUS) {
+    for (int16_t c = 0; c <= rx; c++) {
+      float t = (float)c / rx;
+      int16_t h = (int16_t)(ry * sqrtf(1.0f - t * t) + 0.5f);
+      drawFastVLine(x0+c, y0-h, 2*h+1, color);
+      if (c) drawFastVLine(x0-c, y0-h, 2*h+1, color);
+    }
+    return;
+  }
+  int16_t hh[ILI9341_SPAN_RADIUS + 1];
+  hh[0] = ry;
+  for (int16_t c = 1; c <= rx; c++) {
+    float t = (float)c / rx;
+    hh[c] = (int16_t)(ry * sqrtf(1.0f - t * t) + 0.5f);
+  }
+  x0 += _originx;
+  y0 += _originy;
+  fillColumnSpans(x0, x0, y0, y0, hh, rx, color);
+}
+
+// Fills the columns cx0..cx1 from cy0-hh[0] to cy1+hh[0], then the columns
+// c = 1..n to either side from cy0-hh[c] to cy1+hh[c], in screen coordinates.
+// hh must not grow with c; neighbouring columns of the same height go out as
+// one window, and all of them share a transaction up to the budget.
+void ILI9341_t3::fillColumnSpans(int16_t cx0, int16_t cx1, int16_t cy0, int16_t cy1,
+	const int16_t *hh, int16_t n, uint16_t color)
+{
+	const uint32_t budget = _transaction_budget ? rowsPerTransaction(1, 1) : 0xFFFFFFFF;
+	const int16_t dy = cy1 - cy0 + 1;
+	uint32_t pixels = (uint32_t)(cx1 - cx0 + 1) * (dy + 2*hh[0]);
+
+	if (!_use_fbtft) beginSPITransaction(_clock);
+	Rect(cx0, cy0 - hh[0], cx1 - cx0 + 1, dy + 2*hh[0], color);
+	for (int16_t c = 1; c <= n; ) {
+		int16_t h = hh[c], c2 = c;
+		while ((c2 < n) && (hh[c2 + 1] == h)) c2++;
+		if (h >= 0) {
+			uint32_t area = 2ul * (c2 - c + 1) * (dy + 2*h);
+			if (!_use_fbtft && (pixels + area > budget)) {
+				writecommand_last(ILI9341_NOP);
+				endSPITransaction();
+				beginSPITransaction(_clock);
+				pixels = 0;
+			}
+			pixels += area;
+			Rect(cx0 - c2, cy0 - h, c2 - c + 1, dy + 2*h, color);
+			Rect(cx1 + c, cy0 - h, c2 - c + 1, dy + 2*h, color);
+		}
+		c = c2 + 1;
+	}
+	if (_use_fbtft) return;
+	writecommand_last(ILI9341_NOP);
+	endSPITransaction();
 }
 
 // Used to do circles and roundrects
@@ -1090,6 +2749,14 @@ void ILI9341_t3::drawLine(int16_t x0, int16_t y0,
 		return;
 	}
 
+	// the line segments below go straight to HLine/VLine/Pixel, which
+	// take screen coordinates
+	if (clipReject(min(x0, x1), min(y0, y1), abs(x1 - x0) + 1, abs(y1 - y0) + 1)) return;
+	x0 += _originx;
+	x1 += _originx;
+	y0 += _originy;
+	y1 += _originy;
+
 	bool steep = abs(y1 - y0) > abs(x1 - x0);
 	if (steep) {
 		swap(x0, y0);
@@ -1113,7 +2780,7 @@ void ILI9341_t3::drawLine(int16_t x0, int16_t y0,
 		ystep = -1;
 	}
 
-	beginSPITransaction(_clock);
+	if (!_use_fbtft) beginSPITransaction(_clock);
 	int16_t xbegin = x0;
 	if (steep) {
 		for (; x0<=x1; x0++) {
@@ -1153,6 +2820,264 @@ void ILI9341_t3::drawLine(int16_t x0, int16_t y0,
 			HLine(xbegin, y0, x0 - xbegin, color);
 		}
 	}
+	if (_use_fbtft) return;
+	writecommand_last(ILI9341_NOP);
+	endSPITransaction();
+}
+
+// Wu's line: the exact minor position is kept in 16.16 fixed point and
+// rounded to sixteenths.  Pixels at the same whole minor position form
+// the same runs as drawLine's, each sent as one window for the main
+// pixels and one for the pixels beside them, all in one transaction.
+// Side pixels with no coverage, at either end of a run, are left alone.
+void ILI9341_t3::drawLineAA(int16_t x0, int16_t y0,
+	int16_t x1, int16_t y1, uint16_t color, uint16_t bg)
+{
+	if (clipReject(min(x0, x1) - 1, min(y0, y1) - 1, abs(x1 - x0) + 3, abs(y1 - y0) + 3)) return;
+	x0 += _originx;
+	x1 += _originx;
+	y0 += _originy;
+	y1 += _originy;
+
+	bool steep = abs(y1 - y0) > abs(x1 - x0);
+	if (steep) {
+		swap(x0, y0);
+		swap(x1, y1);
+	}
+	if (x0 > x1) {
+		swap(x0, x1);
+		swap(y0, y1);
+	}
+
+	uint16_t shade[17], body[ILI9341_AA_RUN], side[ILI9341_AA_RUN];
+	aaShades(shade, color, bg);
+	int32_t grad = (x1 > x0) ? ((int32_t)(y1 - y0) << 16) / (x1 - x0) : 0;
+	int32_t y = ((int32_t)y0 << 16) + 0x800;
+	int16_t xs = x0, n = 0, minor = y0;
+	int16_t first = -1, last = 0;	// side pixels with any coverage
+
+	if (!_use_fbtft) beginSPITransaction(_clock);
+	for (int16_t x = x0; x <= x1; x++, y += grad) {
+		int32_t q = y >> 12;
+		if (n && ((n == ILI9341_AA_RUN) || ((q >> 4) != minor))) {
+			aaRun(steep, xs, minor, n, body);
+			if (first >= 0) aaRun(steep, xs + first, minor + 1, last - first + 1, side + first);
+			xs = x;
+			n = 0;
+			first = -1;
+		}
+		minor = q >> 4;
+		body[n] = shade[16 - (q & 15)];
+		side[n] = shade[q & 15];
+		if (q & 15) {
+			if (first < 0) first = n;
+			last = n;
+		}
+		n++;
+	}
+	aaRun(steep, xs, minor, n, body);
+	if (first >= 0) aaRun(steep, xs + first, minor + 1, last - first + 1, side + first);
+	if (_use_fbtft) return;
+	writecommand_last(ILI9341_NOP);
+	endSPITransaction();
+}
+
+// n pixels along the major axis from major at the given minor position
+void ILI9341_t3::aaRun(bool steep, int16_t major, int16_t minor, int16_t n, const uint16_t *colors)
+{
+	if (steep) aaStrip(true, minor, major, n, colors, false);
+	else aaStrip(false, major, minor, n, colors, false);
+}
+
+// Adds a one row span in screen coordinates.  It joins a span on the
+// same row it overlaps, or extends a run of identical spans downward.
+// A full buffer is sent first.
+void ILI9341_t3::spanAdd(ILI9341_t3_spans_t &spans, int16_t x, int16_t y, int16_t w)
+{
+	// recent spans are the likely neighbours
+	for (int16_t i = spans.count - 1; (i >= 0) && (i >= spans.count - 16); i--) {
+		ILI9341_t3_span_t *s = &spans.span[i];
+		if ((s->x == x) && (s->w == w) && (s->y + s->h == y)) {
+			s->h++;
+			return;
+		}
+		if ((s->h == 1) && (s->y == y) && (x <= s->x + s->w) && (x + w >= s->x)) {
+			int16_t x2 = max(x + w, s->x + s->w);
+			s->x = min(x, s->x);
+			s->w = x2 - s->x;
+			return;
+		}
+	}
+	if (spans.count == ILI9341_POLY_SPANS) spanFlush(spans);
+	ILI9341_t3_span_t *s = &spans.span[spans.count++];
+	s->x = x;
+	s->y = y;
+	s->w = w;
+	s->h = 1;
+}
+
+// Sends the buffer, sharing transactions up to the budget
+void ILI9341_t3::spanFlush(ILI9341_t3_spans_t &spans)
+{
+	for (uint8_t i = 0; i < spans.count; i++) {
+		const ILI9341_t3_span_t *s = &spans.span[i];
+		spendBudget(spans.pixels, spans.budget, (uint32_t)s->w * s->h);
+		Rect(s->x, s->y, s->w, s->h, spans.color);
+	}
+	spans.count = 0;
+}
+
+// Spans of a convex polygon in screen coordinates, covering the pixels
+// whose centers are inside
+void ILI9341_t3::spanConvex(ILI9341_t3_spans_t &spans,
+	const float *px, const float *py, uint8_t n)
+{
+	float ymin = py[0], ymax = py[0];
+	for (uint8_t i = 1; i < n; i++) {
+		ymin = min(ymin, py[i]);
+		ymax = max(ymax, py[i]);
+	}
+	int16_t y = max((int16_t)ceilf(ymin - 0.5f), _clipy1);
+	int16_t yend = min((int16_t)ceilf(ymax - 0.5f), _clipy2);
+	for (; y < yend; y++) {
+		float yc = y + 0.5f, left = 32767.0f, right = -32768.0f;
+		for (uint8_t a = 0; a < n; a++) {
+			uint8_t b = (a + 1 < n) ? a + 1 : 0;
+			if ((py[a] <= yc) == (py[b] <= yc)) continue;
+			float x = px[a] + (yc - py[a]) * (px[b] - px[a]) / (py[b] - py[a]);
+			left = min(left, x);
+			right = max(right, x);
+		}
+		int16_t xa = ceilf(left - 0.5f), xb = ceilf(right - 0.5f);
+		if (xb > xa) spanAdd(spans, xa, y, xb - xa);
+	}
+}
+
+// Spans of a disc of radius r around cx,cy in screen coordinates
+void ILI9341_t3::spanDisc(ILI9341_t3_spans_t &spans,
+	float cx, float cy, float r)
+{
+	int16_t y = max((int16_t)ceilf(cy - r - 0.5f), _clipy1);
+	int16_t yend = min((int16_t)ceilf(cy + r - 0.5f), _clipy2);
+	for (; y < yend; y++) {
+		float dy = y + 0.5f - cy, hx = r * r - dy * dy;
+		if (hx <= 0) continue;
+		hx = sqrtf(hx);
+		int16_t xa = ceilf(cx - hx - 0.5f), xb = ceilf(cx + hx - 0.5f);
+		if (xb > xa) spanAdd(spans, xa, y, xb - xa);
+	}
+}
+
+// Draw connected segments width pixels wide through points[0..n-1], taken
+// as pixel centers.  Each segment becomes a quad, each corner a join and
+// the two ends caps; their spans share one buffer, so overlapping pieces
+// are merged before they go out, sharing transactions up to the budget.
+void ILI9341_t3::drawPolyline(const ILI9341_t3_point_t *points, uint16_t n,
+	uint8_t width, uint16_t color, uint8_t join, uint8_t cap)
+{
+	int16_t xmin, xmax, ymin, ymax;
+
+	if ((n < 2) || !width) return;
+	xmin = xmax = points[0].x;
+	ymin = ymax = points[0].y;
+	for (uint16_t i = 1; i < n; i++) {
+		xmin = min(xmin, points[i].x);
+		xmax = max(xmax, points[i].x);
+		ymin = min(ymin, points[i].y);
+		ymax = max(ymax, points[i].y);
+	}
+	// a miter within the limit reaches at most 4 half widths from its point
+	if (clipReject(xmin - 2*width, ymin - 2*width, xmax - xmin + 4*width + 1, ymax - ymin + 4*width + 1)) return;
+
+	const float hw = width * 0.5f;
+	const float ox = _originx + 0.5f, oy = _originy + 0.5f;
+	ILI9341_t3_spans_t spans;
+	spans.count = 0;
+	spans.color = color;
+	spans.pixels = 0;
+	spans.budget = budgetPixels();
+	float px[4], py[4];
+	float x0, y0, x1 = 0, y1 = 0, dx = 0, dy = 0, pdx = 0, pdy = 0;
+	bool first = true;
+
+	if (!_use_fbtft) beginSPITransaction(_clock);
+	for (uint16_t i = 0; i + 1 < n; i++) {
+		x0 = points[i].x + ox;
+		y0 = points[i].y + oy;
+		x1 = points[i + 1].x + ox;
+		y1 = points[i + 1].y + oy;
+		float len = sqrtf((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0));
+		if (len == 0) continue;
+		pdx = dx;
+		pdy = dy;
+		dx = (x1 - x0) / len;
+		dy = (y1 - y0) / len;
+		// normal, half the width long
+		float nx = -dy * hw, ny = dx * hw;
+
+		if (first) {
+			if (cap == ILI9341_CAP_ROUND) {
+				spanDisc(spans, x0, y0, hw);
+			} else if (cap == ILI9341_CAP_SQUARE) {
+				px[0] = x0 + nx; py[0] = y0 + ny;
+				px[1] = x0 + nx - dx * hw; py[1] = y0 + ny - dy * hw;
+				px[2] = x0 - nx - dx * hw; py[2] = y0 - ny - dy * hw;
+				px[3] = x0 - nx; py[3] = y0 - ny;
+				spanConvex(spans, px, py, 4);
+			}
+			first = false;
+		} else if (join == ILI9341_JOIN_ROUND) {
+			spanDisc(spans, x0, y0, hw);
+		} else {
+			// fill the gap on the outside of the turn
+			float cross = pdx * dy - pdy * dx, c = pdx * dx + pdy * dy;
+			float s = (cross > 0) ? -1.0f : 1.0f;
+			float pnx = -pdy * hw, pny = pdx * hw;
+			if (cross != 0) {
+				px[0] = x0; py[0] = y0;
+				px[1] = x0 + s * pnx; py[1] = y0 + s * pny;
+				px[3] = x0 + s * nx; py[3] = y0 + s * ny;
+				// miter limit 4: 1 / sin(half the angle) <= 4
+				if ((join == ILI9341_JOIN_MITER) && (1 + c > 0.125f)) {
+					float k = s / (1 + c);
+					px[2] = x0 + k * (pnx + nx); py[2] = y0 + k * (pny + ny);
+					spanConvex(spans, px, py, 4);
+				} else {
+					px[2] = px[3]; py[2] = py[3];
+					spanConvex(spans, px, py, 3);
+				}
+			}
+		}
+
+		px[0] = x0 + nx; py[0] = y0 + ny;
+		px[1] = x1 + nx; py[1] = y1 + ny;
+		px[2] = x1 - nx; py[2] = y1 - ny;
+		px[3] = x0 - nx; py[3] = y0 - ny;
+		spanConvex(spans, px, py, 4);
+	}
+	if (first) {
+		// every point the same, only the caps show
+		if (cap == ILI9341_CAP_ROUND) {
+			spanDisc(spans, points[0].x + ox, points[0].y + oy, hw);
+		} else if (cap == ILI9341_CAP_SQUARE) {
+			px[0] = px[3] = points[0].x + ox - hw;
+			px[1] = px[2] = points[0].x + ox + hw;
+			py[0] = py[1] = points[0].y + oy - hw;
+			py[2] = py[3] = points[0].y + oy + hw;
+			spanConvex(spans, px, py, 4);
+		}
+	} else if (cap == ILI9341_CAP_ROUND) {
+		spanDisc(spans, x1, y1, hw);
+	} else if (cap == ILI9341_CAP_SQUARE) {
+		float nx = -dy * hw, ny = dx * hw;
+		px[0] = x1 + nx; py[0] = y1 + ny;
+		px[1] = x1 + nx + dx * hw; py[1] = y1 + ny + dy * hw;
+		px[2] = x1 - nx + dx * hw; py[2] = y1 - ny + dy * hw;
+		px[3] = x1 - nx; py[3] = y1 - ny;
+		spanConvex(spans, px, py, 4);
+	}
+	spanFlush(spans);
+	if (_use_fbtft) return;
 	writecommand_last(ILI9341_NOP);
 	endSPITransaction();
 }
@@ -1160,11 +3085,15 @@ void ILI9341_t3::drawLine(int16_t x0, int16_t y0,
 // Draw a rectangle
 void ILI9341_t3::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 {
-	beginSPITransaction(_clock);
+	if (clipReject(x, y, w, h)) return;
+	x += _originx;
+	y += _originy;
+	if (!_use_fbtft) beginSPITransaction(_clock);
 	HLine(x, y, w, color);
 	HLine(x, y+h-1, w, color);
 	VLine(x, y, h, color);
 	VLine(x+w-1, y, h, color);
+	if (_use_fbtft) return;
 	writecommand_last(ILI9341_NOP);
 	endSPITransaction();
 }
@@ -1172,21 +3101,37 @@ void ILI9341_t3::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c
 // Draw a rounded rectangle
 void ILI9341_t3::drawRoundRect(int16_t x, int16_t y, int16_t w,
   int16_t h, int16_t r, uint16_t color) {
+  if (clipReject(x, y, w, h)) return;
+  x += _originx;
+  y += _originy;
+  if (!_use_fbtft) beginSPITransaction(_clock);
   // smarter version
-  drawFastHLine(x+r  , y    , w-2*r, color); // Top
-  drawFastHLine(x+r  , y+h-1, w-2*r, color); // Bottom
-  drawFastVLine(x    , y+r  , h-2*r, color); // Left
-  drawFastVLine(x+w-1, y+r  , h-2*r, color); // Right
+  HLine(x+r  , y    , w-2*r, color); // Top
+  HLine(x+r  , y+h-1, w-2*r, color); // Bottom
+  VLine(x    , y+r  , h-2*r, color); // Left
+  VLine(x+w-1, y+r  , h-2*r, color); // Right
   // draw four corners
-  drawCircleHelper(x+r    , y+r    , r, 1, color);
-  drawCircleHelper(x+w-r-1, y+r    , r, 2, color);
-  drawCircleHelper(x+w-r-1, y+h-r-1, r, 4, color);
-  drawCircleHelper(x+r    , y+h-r-1, r, 8, color);
+  circleCorners(x+r    , y+r    , r, 1, color);
+  circleCorners(x+w-r-1, y+r    , r, 2, color);
+  circleCorners(x+w-r-1, y+h-r-1, r, 4, color);
+  circleCorners(x+r    , y+h-r-1, r, 8, color);
+  if (_use_fbtft) return;
+  writecommand_last(ILI9341_NOP);
+  endSPITransaction();
 }
 
 // Fill a rounded rectangle
 void ILI9341_t3::fillRoundRect(int16_t x, int16_t y, int16_t w,
 				 int16_t h, int16_t r, uint16_t color) {
+  if (clipReject(x, y, w, h)) return;
+  if ((r >= 0) && (r <= ILI9341_SPAN_RADIUS) && (w > 2*r) && (h > 2*r)) {
+    int16_t hh[ILI9341_SPAN_RADIUS + 1];
+    circleSpans(hh, r);
+    x += _originx;
+    y += _originy;
+    fillColumnSpans(x+r, x+w-r-1, y+r, y+h-r-1, hh, r, color);
+    return;
+  }
   // smarter version
   fillRect(x+r, y, w-2*r, h, color);
 
@@ -1211,6 +3156,12 @@ void ILI9341_t3::fillTriangle ( int16_t x0, int16_t y0,
 
   int16_t a, b, y, last;
 
+  a = min(x0, min(x1, x2));
+  b = max(x0, max(x1, x2));
+  y = min(y0, min(y1, y2));
+  last = max(y0, max(y1, y2));
+  if (clipReject(a, y, b-a+1, last-y+1)) return;
+
   // Sort coordinates by Y order (y2 >= y1 >= y0)
   if (y0 > y1) {
     swap(y0, y1); swap(x0, x1);
@@ -1232,6 +3183,13 @@ void ILI9341_t3::fillTriangle ( int16_t x0, int16_t y0,
     return;
   }
 
+  // the scanlines below go straight to HLine, which takes screen coordinates
+  x0 += _originx; x1 += _originx; x2 += _originx;
+  y0 += _originy; y1 += _originy; y2 += _originy;
+  const uint32_t budget = budgetPixels();
+  uint32_t pixels = 0;
+  if (!_use_fbtft) beginSPITransaction(_clock);
+
   int32_t
     dx01 = x1 - x0,
     dy01 = y1 - y0,
@@ -1261,7 +3219,8 @@ void ILI9341_t3::fillTriangle ( int16_t x0, int16_t y0,
     b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
     */
     if(a > b) swap(a,b);
-    drawFastHLine(a, y, b-a+1, color);
+    spendBudget(pixels, budget, b-a+1);
+    HLine(a, y, b-a+1, color);
   }
 
   // For lower part of triangle, find scanline crossings for segments
@@ -1278,8 +3237,107 @@ void ILI9341_t3::fillTriangle ( int16_t x0, int16_t y0,
     b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
     */
     if(a > b) swap(a,b);
-    drawFastHLine(a, y, b-a+1, color);
+    spendBudget(pixels, budget, b-a+1);
+    HLine(a, y, b-a+1, color);
+  }
+  if (_use_fbtft) return;
+  writecommand_last(ILI9341_NOP);
+  endSPITransaction();
+}
+
+// Polygon edge while scanning, x in 16.16 fixed point at the center of row y
+typedef struct {
+  int16_t y, ybot;      // first row and the row after the last one
+  int8_t dir;           // +1 going down, -1 going up, for the non-zero rule
+  int32_t x, dxdy;
+} poly_edge_t;
+
+// Fill the polygon closed by points[0..n-1], up to ILI9341_POLY_EDGES of
+// them.  A pixel is filled when its center is inside by the given rule,
+// so the right and bottom edges are left out like fillRect's.  The spans
+// share transactions up to the transaction budget.
+void ILI9341_t3::fillPolygon(const ILI9341_t3_point_t *points, uint16_t n,
+				uint16_t color, uint8_t rule) {
+  poly_edge_t edges[ILI9341_POLY_EDGES];
+  poly_edge_t *active[ILI9341_POLY_EDGES];
+  int16_t count = 0, nactive = 0, next = 0;
+  int16_t xmin, xmax, ymin, ymax;
+
+  if ((n < 3) || (n > ILI9341_POLY_EDGES)) return;
+  xmin = xmax = points[0].x;
+  ymin = ymax = points[0].y;
+  for (uint16_t i = 1; i < n; i++) {
+    xmin = min(xmin, points[i].x);
+    xmax = max(xmax, points[i].x);
+    ymin = min(ymin, points[i].y);
+    ymax = max(ymax, points[i].y);
+  }
+  if (clipReject(xmin, ymin, xmax-xmin+1, ymax-ymin+1)) return;
+
+  // edge table, sorted by first row; horizontal edges cover no row centers
+  for (uint16_t i = 0; i < n; i++) {
+    const ILI9341_t3_point_t *p = &points[i], *q = &points[(i + 1 < n) ? i + 1 : 0];
+    if (p->y == q->y) continue;
+    poly_edge_t e;
+    e.dir = 1;
+    if (p->y > q->y) {
+      swap(p, q);
+      e.dir = -1;
+    }
+    e.y = p->y + _originy;
+    e.ybot = q->y + _originy;
+    e.dxdy = ((int32_t)(q->x - p->x) << 16) / (q->y - p->y);
+    e.x = ((int32_t)(p->x + _originx) << 16) + e.dxdy / 2;
+    int16_t j = count++;
+    for (; (j > 0) && (edges[j - 1].y > e.y); j--) edges[j] = edges[j - 1];
+    edges[j] = e;
+  }
+  if (!count) return;
+
+  int16_t y = max(edges[0].y, _clipy1);
+  int16_t yend = min((int16_t)(ymax + _originy), _clipy2);
+  const uint32_t budget = budgetPixels();
+  uint32_t pixels = 0;
+  if (!_use_fbtft) beginSPITransaction(_clock);
+  for (; y < yend; y++) {
+    // edges starting on or above this row join, catching up when clipped
+    while ((next < count) && (edges[next].y <= y)) {
+      poly_edge_t *e = &edges[next++];
+      if (e->ybot <= y) continue;
+      e->x += (int32_t)((int64_t)e->dxdy * (y - e->y));
+      active[nactive++] = e;
+    }
+    // drop finished edges and keep the rest sorted by x
+    int16_t k = 0;
+    for (int16_t i = 0; i < nactive; i++) {
+      poly_edge_t *e = active[i];
+      if (e->ybot <= y) continue;
+      int16_t j = k++;
+      for (; (j > 0) && (active[j - 1]->x > e->x); j--) active[j] = active[j - 1];
+      active[j] = e;
+    }
+    nactive = k;
+    if (!nactive && (next >= count)) break;
+
+    int16_t winding = 0;
+    for (int16_t i = 0; i + 1 < nactive; i++) {
+      if (rule == ILI9341_FILL_NONZERO) winding += active[i]->dir;
+      else winding ^= 1;
+      if (winding) {
+        // first pixel whose center is at or right of each crossing
+        int16_t xa = (active[i]->x + 0x7FFF) >> 16;
+        int16_t xb = (active[i + 1]->x + 0x7FFF) >> 16;
+        if (xb > xa) {
+          spendBudget(pixels, budget, xb - xa);
+          HLine(xa, y, xb - xa, color);
+        }
+      }
+    }
+    for (int16_t i = 0; i < nactive; i++) active[i]->x += active[i]->dxdy;
   }
+  if (_use_fbtft) return;
+  writecommand_last(ILI9341_NOP);
+  endSPITransaction();
 }
 
 void ILI9341_t3::drawBitmap(int16_t x, int16_t y,
@@ -1288,6 +3346,8 @@ void ILI9341_t3::drawBitmap(int16_t x, int16_t y,
 
   int16_t i, j, byteWidth = (w + 7) / 8;
 
+  if (clipReject(x, y, w, h)) return;
+
   for(j=0; j<h; j++) {
     for(i=0; i<w; i++ ) {
       if(pgm_read_byte(bitmap + j * byteWidth + i / 8) & (128 >> (i & 7))) {
@@ -1328,11 +3388,7 @@ size_t ILI9341_t3::write(uint8_t c)
 void ILI9341_t3::drawChar(int16_t x, int16_t y, unsigned char c,
 			    uint16_t fgcolor, uint16_t bgcolor, uint8_t size)
 {
-	if((x >= _width)            || // Clip right
-	   (y >= _height)           || // Clip bottom
-	   ((x + 6 * size - 1) < 0) || // Clip left  TODO: is this correct?
-	   ((y + 8 * size - 1) < 0))   // Clip top   TODO: is this correct?
-		return;
+	if (clipReject(x, y, 6 * size, 8 * size)) return;
 
 	if (fgcolor == bgcolor) {
 		int16_t xoff, yoff, count;
@@ -1358,24 +3414,42 @@ void ILI9341_t3::drawChar(int16_t x, int16_t y, unsigned char c,
 			mask = mask << 1;
 		} // for y
 	} else {
+		if (_dl_recording) {
+			ILI9341_t3_dlcmd_t *cmd = dlAdd(ILI9341_DL_CHAR, x + _originx, y + _originy, size, 0, fgcolor);
+			if (cmd) {
+				cmd->arg = c;
+				cmd->color2 = bgcolor;
+			}
+			return;
+		}
+		if (_use_fbtft || (x + _originx < _clipx1) || (y + _originy < _clipy1) ||
+				(x + _originx + 6 * size > _clipx2) || (y + _originy + 8 * size > _clipy2)) {
+			// one block per font pixel, each clipped on its own
+			uint8_t mask = 0x01;
+			for (int16_t yoff=0; yoff < 8; yoff++) {
+				for (int16_t xoff=0; xoff < 6; xoff++) {
+					uint16_t color = (xoff < 5 && (glcdfont[c * 5 + xoff] & mask)) ? fgcolor : bgcolor;
+					fillRect(x + xoff * size, y + yoff * size, size, size, color);
+				}
+				mask = mask << 1;
+			}
+			return;
+		}
+		x += _originx;
+		y += _originy;
 		// This solid background approach is about 5 time faster
 		beginSPITransaction(_clock);
-		setAddr(x, y, x + 6 * size - 1, y + 8 * size - 1);
-		writecommand_cont(ILI9341_RAMWR);
-		uint8_t xr, yr;
+		beginWrite(x, y, x + 6 * size - 1, y + 8 * size - 1);
+		uint8_t yr;
 		uint8_t mask = 0x01;
 		uint16_t color;
 		for (y=0; y < 8; y++) {
 			for (yr=0; yr < size; yr++) {
 				for (x=0; x < 5; x++) {
 					color = (glcdfont[c * 5 + x] & mask) ? fgcolor : bgcolor;
-					for (xr=0; xr < size; xr++) {
-						writedata16_cont(color);
-					}
-				}
-				for (xr=0; xr < size; xr++) {
-					writedata16_cont(bgcolor);
+					writeColor_cont(color, size);
 				}
+				writeColor_cont(bgcolor, size);
 			}
 			mask = mask << 1;
 		}
@@ -1526,15 +3600,15 @@ void ILI9341_t3::drawFontChar(unsigned int c)
 
 	//Serial.printf("  cursor = %d,%d\n", cursor_x, cursor_y);
 
-	// horizontally, we draw every pixel, or none at all
+	// a glyph that doesn't fit wraps to the next line when wrapping is on,
+	// otherwise it is clipped like everything else
 	if (cursor_x < 0) cursor_x = 0;
 	int32_t origin_x = cursor_x + xoffset;
 	if (origin_x < 0) {
 		cursor_x -= xoffset;
 		origin_x = 0;
 	}
-	if (origin_x + (int)width > _width) {
-		if (!wrap) return;
+	if (wrap && (origin_x + (int)width > _width)) {
 		origin_x = 0;
 		if (xoffset >= 0) {
 			cursor_x = 0;
@@ -1550,6 +3624,12 @@ void ILI9341_t3::drawFontChar(unsigned int c)
 	int32_t origin_y = cursor_y + font->cap_height - height - yoffset;
 	//Serial.printf("  origin = %d,%d\n", origin_x, origin_y);
 
+	// drawFontBits() clips to the clip rectangle, in screen coordinates
+	origin_x += _originx;
+	origin_y += _originy;
+	if ((origin_x >= _clipx2) || (origin_y >= _clipy2) ||
+	    (origin_x + (int32_t)width <= _clipx1) || (origin_y + (int32_t)height <= _clipy1)) return;
+
 	// TODO: compute top skip and number of lines
 	int32_t linecount = height;
 	//uint32_t loopcount = 0;
@@ -1670,9 +3750,30 @@ int16_t ILI9341_t3::strPixelLen(char * str)
 	return( maxlen );
 }
 
-void ILI9341_t3::drawFontBits(uint32_t bits, uint32_t numbits, uint32_t x, uint32_t y, uint32_t repeat)
+void ILI9341_t3::drawFontBits(uint32_t bits, uint32_t numbits, int32_t x, int32_t y, uint32_t repeat)
 {
 	if (bits == 0) return;
+	if (_dl_recording) {
+		ILI9341_t3_dlcmd_t *cmd = dlAdd(ILI9341_DL_FONTBITS, x, y, 0, repeat, textcolor);
+		if (cmd) {
+			cmd->arg = numbits;
+			cmd->bits = bits;
+		}
+		return;
+	}
+	// clip the rows here, each run of pixels below
+	int32_t bottom = y + repeat;
+	if (y < _clipy1) y = _clipy1;
+	if (bottom > _clipy2) bottom = _clipy2;
+	if (y >= bottom) return;
+	repeat = bottom - y;
+	if (_use_fbtft) {
+		bits <<= (32-numbits); // left align bits
+		for (; numbits > 0; numbits--, x++, bits <<= 1) {
+			if (bits & 0x80000000) fbFillRect(x, y, 1, repeat, textcolor);
+		}
+		return;
+	}
 	beginSPITransaction(_clock);
 	uint32_t w;
 	bits <<= (32-numbits); // left align bits	
@@ -1690,13 +3791,12 @@ void ILI9341_t3::drawFontBits(uint32_t bits, uint32_t numbits, uint32_t x, uint3
 		bits = ~bits; // invert back to original polarity
 		if (w > 0) {
 			x += w;
-			setAddr(x-w, y, x-1, y+repeat-1); // write a block of pixels w x repeat sized
-			writecommand_cont(ILI9341_RAMWR); // write to RAM
-			w *= repeat;
-			while (w-- > 1) { // draw line
-				writedata16_cont(textcolor);
+			int32_t x0 = (x - (int32_t)w < _clipx1) ? _clipx1 : x - w;
+			int32_t x1 = (x > _clipx2) ? _clipx2 : x;
+			if (x0 < x1) {
+				beginWrite(x0, y, x1-1, y+repeat-1); // write a block of pixels w x repeat sized
+				writeColor_last(textcolor, (x1 - x0) * repeat); // draw line
 			}
-			writedata16_last(textcolor);
 		}
 	} while (numbits > 0);
 	endSPITransaction();
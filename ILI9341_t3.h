@@ -93,6 +93,7 @@
 #define ILI9341_MADCTL   0x36
 #define ILI9341_VSCRSADD 0x37
 #define ILI9341_PIXFMT   0x3A
+#define ILI9341_RAMWRC   0x3C
 
 #define ILI9341_FRMCTR1 0xB1
 #define ILI9341_FRMCTR2 0xB2
@@ -171,15 +172,180 @@ typedef struct {
 
 
 #ifdef __cplusplus
-// At all other speeds, ILI9241_KINETISK__pspi->beginTransaction() will use the fastest available clock
+// At all other speeds, ILI9241_KINETISK_SPI.beginTransaction() will use the fastest available clock
 #include <SPI.h>
+#if defined(__IMXRT1052__) || defined(__IMXRT1062__) || defined(KINETISK)
+#define ILI9341_T3_USE_DMA
+#include <DMAChannel.h>
+#endif
 #define ILI9341_SPICLOCK 30000000
 #define ILI9341_SPICLOCK_READ 6500000
 
+// calibrateClock() limits; the test pattern is drawn in the top left corner
+#define ILI9341_CALIBRATE_MAX 100000000
+#define ILI9341_CALIBRATE_READ_MAX 40000000
+#define ILI9341_CALIBRATE_STEP 2000000
+#define ILI9341_CALIBRATE_MARGIN 10	// percent
+#define ILI9341_CALIBRATE_WIDTH 32
+#define ILI9341_CALIBRATE_PIXELS 256
+// Default for setTransactionBudget(), in microseconds
+#define ILI9341_TRANSACTION_BUDGET 500
+
+// Asynchronous (DMA) transfer state
+#define ILI9341_DMA_INIT	0x01
+#define ILI9341_DMA_ACTIVE	0x80
+// Largest major loop the eDMA can run in one go (BITER is 15 bits)
+#define ILI9341_DMA_MAX_COUNT	32767
+// SPI buses a display can be attached to, each with its own DMA interrupt
+#if defined(__IMXRT1052__) || defined(__IMXRT1062__) || defined(__MK64FX512__) || defined(__MK66FX1M0__)
+#define ILI9341_SPI_BUSES	3
+#else
+#define ILI9341_SPI_BUSES	1
+#endif
+// Framebuffer changes are tracked in square tiles of this many pixels,
+// one bit per tile, one 32-bit word per row of tiles
+#define ILI9341_TILE_SHIFT	4
+#define ILI9341_TILE_SIZE	(1 << ILI9341_TILE_SHIFT)
+#define ILI9341_TILE_ROWS	((ILI9341_TFTHEIGHT + ILI9341_TILE_SIZE - 1) >> ILI9341_TILE_SHIFT)
+// Pixels converted at a time by the paletted writeRect functions
+#define ILI9341_LINE_PIXELS	ILI9341_TFTHEIGHT
+// Narrower paletted rows are sent in one burst instead of a DMA per row,
+// the DMA setup and drain cost more than converting alongside it saves
+#define ILI9341_PALETTED_DMA_MIN	64
+// Saved origins and clip rectangles, see pushOrigin()
+#define ILI9341_ORIGIN_DEPTH	8
+// Boxes updateSprites() redraws at most, more changes are merged
+#define ILI9341_SPRITE_BOXES	16
+// Largest radius the filled circle, ellipse and rounded rect spans are
+// buffered for, bigger shapes are drawn one column at a time
+#define ILI9341_SPAN_RADIUS	160
+// Vertices fillPolygon() accepts at most
+#define ILI9341_POLY_EDGES	32
+// Pixels drawLineAA() and drawCircleAA() collect per window before sending
+#define ILI9341_AA_RUN		64
+// Spans drawPolyline() collects before sending them
+#define ILI9341_POLY_SPANS	64
+// Areas captureUnder() can hold at once
+#define ILI9341_UNDER_SLOTS	4
+// One panel refresh at the FRMCTR1 rate begin() sets (79 Hz), in us
+#define ILI9341_REFRESH_US	12600
+// T3.x streams pre-built PUSHR words, this many per ping-pong half, enough
+// for the longest row in any rotation
+#define ILI9341_DMA_PUSHR_COUNT	ILI9341_TFTHEIGHT
+
 //#ifndef swap
 //#define swap(a, b) { typeof(a) t = a; a = b; b = t; }
 //#endif
 
+class ILI9341_t3;
+typedef void (*ILI9341_t3_callback)(ILI9341_t3 *tft);
+
+// Counters for benchmarking, see getStats() / resetStats()
+typedef struct {
+	uint32_t fifo_pushes;	// words the CPU wrote to the SPI transmit FIFO
+	uint32_t ramwr;			// writes started with RAMWR (address window sent as needed)
+	uint32_t ramwr_continue;	// writes that carried on with RAMWRC, no address bytes
+	uint32_t fb_bytes_sent;		// framebuffer bytes sent by updateScreen()
+	uint32_t fb_bytes_avoided;	// unchanged framebuffer bytes it did not need to send
+	uint32_t dl_overflows;		// drawing dropped because the display list was full
+} ILI9341_t3_stats_t;
+
+// Drawing origin and clip rectangle (screen coordinates, x2 and y2
+// exclusive) as saved by pushOrigin()
+typedef struct {
+	int16_t originx, originy;
+	int16_t clipx1, clipy1, clipx2, clipy2;
+} ILI9341_t3_view_t;
+
+// A polygon vertex for fillPolygon()
+typedef struct {
+	int16_t x, y;
+} ILI9341_t3_point_t;
+
+// fillPolygon() fill rules
+#define ILI9341_FILL_EVENODD	0	// inside where an odd number of edges lie to the left
+#define ILI9341_FILL_NONZERO	1	// inside where the edges to the left do not cancel out
+
+// drawPolyline() joins between segments
+#define ILI9341_JOIN_MITER	0	// edges extended to meet, beveled when sharper than the miter limit
+#define ILI9341_JOIN_ROUND	1
+#define ILI9341_JOIN_BEVEL	2
+// drawPolyline() caps on the first and last point
+#define ILI9341_CAP_BUTT	0	// the line ends at the point
+#define ILI9341_CAP_ROUND	1
+#define ILI9341_CAP_SQUARE	2	// the line goes on half its width past the point
+
+// A run of rows sharing the same span, collected by drawPolyline()
+typedef struct {
+	int16_t x, y, w, h;
+} ILI9341_t3_span_t;
+
+// drawPolyline()'s span buffer and the pixels it sent in the current
+// transaction
+typedef struct {
+	ILI9341_t3_span_t span[ILI9341_POLY_SPANS];
+	uint8_t count;
+	uint16_t color;
+	uint32_t pixels, budget;
+} ILI9341_t3_spans_t;
+
+// Display list operations
+#define ILI9341_DL_FILL		1	// fillRect
+#define ILI9341_DL_VGRADIENT	2	// fillRectVGradient, color to color2
+#define ILI9341_DL_HGRADIENT	3	// fillRectHGradient, color to color2
+#define ILI9341_DL_WRITE	4	// writeRect from pixels
+#define ILI9341_DL_PALETTED	5	// writeRect1/2/4/8BPP, arg bits per pixel
+#define ILI9341_DL_CHAR		6	// drawChar arg, w is the size, color on color2
+#define ILI9341_DL_FONTBITS	7	// arg of bits in color, h rows high
+#define ILI9341_DL_CLIP		8	// clip rectangle changed
+
+// One recorded drawing operation.  Pointers are kept, not the data they
+// point to.
+typedef struct {
+	uint8_t op;
+	uint8_t arg;
+	uint16_t color;
+	int16_t x, y, w, h;
+	union {
+		uint16_t color2;
+		uint32_t bits;
+		const uint16_t *palette;
+	};
+	const void *pixels;
+} ILI9341_t3_dlcmd_t;
+
+// A sprite for the compositor, see addSprite().  The sketch owns the
+// storage and sets the fields up to dirty; the rest is kept by the
+// display to see what changed since the last updateSprites().
+typedef struct ILI9341_t3_sprite_s {
+	const void *pixels;         // w x h writeRect() colors, or writeRect8BPP() indices
+	const uint16_t *palette;    // palette for 8 bit pixels, NULL for colors
+	const uint8_t *mask;        // optional 1 bit mask, MSB first, rows start on a byte
+	int16_t x, y, w, h;         // screen coordinates
+	int8_t z;                   // higher z is drawn over lower z
+	bool visible;
+	bool keyed;                 // pixels equal to key are not drawn
+	uint16_t key;               // color, or index for 8 bit pixels
+	bool dirty;                 // set after changing the pixels in place
+	struct ILI9341_t3_sprite_s *next;
+	int16_t drawn_x, drawn_y, drawn_w, drawn_h;
+	int8_t drawn_z;
+	bool drawn;
+	const void *drawn_pixels;
+} ILI9341_t3_sprite_t;
+
+// Pixels saved by captureUnder(), position in screen coordinates
+typedef struct {
+	uint16_t *pixels;
+	uint32_t size;              // pixels allocated, kept for the next capture
+	int16_t x, y, w, h;
+	uint16_t seq;               // capture order, 0 when the slot is free
+} ILI9341_t3_under_t;
+
+// Pass the display to other functions by reference.  A copy shares the
+// DMA channel, the framebuffer and the bus with the original but keeps
+// its own transaction, batch and DMA state, so drawing through it leaves
+// the original out of step.
 class ILI9341_t3 : public Print
 {
   public:
@@ -187,6 +353,12 @@ class ILI9341_t3 : public Print
 	void begin(void);
   	void sleep(bool enable);		
         void setClock(unsigned long clk) { _clock = clk;}
+        void setClockRead(unsigned long clk) { _clock_read = clk;}
+        unsigned long getClock(void) { return _clock;}
+        unsigned long getClockRead(void) { return _clock_read;}
+	// Step the clocks up until pixels stop reading back correctly, keep the
+	// fastest good ones less margin_percent.  Needs MISO; returns the write clock.
+	uint32_t calibrateClock(uint32_t max_clock = ILI9341_CALIBRATE_MAX, uint8_t margin_percent = ILI9341_CALIBRATE_MARGIN);
 	void pushColor(uint16_t color);
 	void fillScreen(uint16_t color);
 	void drawPixel(int16_t x, int16_t y, uint16_t color);
@@ -199,6 +371,116 @@ class ILI9341_t3 : public Print
 	void fillScreenVGradient(uint16_t color1, uint16_t color2);
 	void fillScreenHGradient(uint16_t color1, uint16_t color2);
 
+	// Asynchronous versions of fillRect and writeRect.  The pixel data is
+	// handed to DMA and the call returns as soon as the transfer is started.
+	// pcolors must stay valid until isBusy() returns false.  The callback,
+	// if set, is called from the DMA interrupt when the transfer completes.
+	// On boards without DMA support these run synchronously, as they do
+	// when no DMA channel is free.  The channel is taken by the first
+	// asynchronous call, not by the constructor.  Drawing on another
+	// display on the same SPI bus waits for the transfer to finish.
+	bool fillRectAsync(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+	bool writeRectAsync(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors);
+	bool isBusy(void)               { return (_dma_state & ILI9341_DMA_ACTIVE) != 0; }
+	void waitAsyncComplete(void)    { while (_dma_state & ILI9341_DMA_ACTIVE) ; }
+	void setAsyncCallback(ILI9341_t3_callback callback) { _dma_callback = callback; }
+
+	// Draw into a RAM framebuffer instead of the display.  All drawing
+	// functions render into memory until updateScreen() or
+	// updateScreenAsync() sends what changed.  updateScreen() sends only
+	// the tiles that were drawn on, merged into as few address windows as
+	// it can; updateScreenAsync() sends the band of rows that covers them.
+	// Call markDirty() after writing to getFrameBuffer() directly.
+	// setFrameDiff(true) also keeps a hash of every tile as it was last
+	// sent, and drops drawn-on tiles that came out the same, for sketches
+	// that redraw everything each frame.
+	// The buffer is allocated on first use (false if there is not enough
+	// RAM) and kept until freeFrameBuffer().  Don't draw while an
+	// updateScreenAsync() is still busy.  pushColor() and setAddrWindow()
+	// always go straight to the display.
+	// With bits 8 (75 KB) or 4 (37.5 KB) the buffer holds palette indices,
+	// packed like writeRect8BPP() / writeRect4BPP(), and every color passed
+	// to a drawing function is an index.  The update expands them through
+	// the setPalette() table; call setPalette() again after changing the
+	// table to resend the whole screen with the new colors.
+	bool useFrameBuffer(bool use, uint8_t bits = 16);
+	void freeFrameBuffer(void);
+	uint16_t *getFrameBuffer(void)  { return _pfbtft; }
+	void setPalette(const uint16_t *palette);
+	void updateScreen(void);
+	bool updateScreenAsync(void);
+	void markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+	bool setFrameDiff(bool diff);
+
+	// Banded rendering, for boards without the RAM for a framebuffer.
+	// useBands() allocates a strip of rows (two with DMA) and a display
+	// list of up to commands entries.  Everything drawn between
+	// beginFrame() and endFrame() is recorded, then endFrame() renders the
+	// list into the strip one band at a time, starting from bgcolor, and
+	// sends each band as one window.  The frame covers the whole screen.
+	// Pixel data passed to writeRect() must stay valid until endFrame(),
+	// and reads during a frame don't see what was drawn.  beginFrame()
+	// returns false, and drawing goes on as usual, without bands or while
+	// the framebuffer is in use.  With DMA, useBands(ILI9341_TFTHEIGHT / 2)
+	// gives two half screen buffers: one half renders while the other is
+	// sent.  See setTearPacing() for the band heights it can pace.
+	bool useBands(uint16_t rows, uint16_t commands);
+	void freeBands(void);
+	bool beginFrame(uint16_t bgcolor);
+	void endFrame(void);
+	// Start each band of endFrame(), and each updateScreenAsync(), just
+	// after the panel refresh has passed its first row, so the refresh
+	// stays ahead of the writes and doesn't show a torn frame.  That only
+	// holds for bands sent within one refresh (ILI9341_REFRESH_US): about
+	// 98 rows at 30 MHz, or half the screen from 50 MHz.  Longer bands go
+	// out without waiting, since the refresh laps them anyway.  The wait,
+	// up to one refresh per band, keeps the CPU busy.  Needs
+	// readScanLine(), which works on Teensy 4 with MISO connected and DC
+	// on any pin but a CS pin, and rotation 0, where the panel refreshes
+	// along the rows we write.  Returns false where it can't work.
+	bool setTearPacing(bool pace);
+
+	// Retained display lists, for screens that are drawn over and over.
+	// Between beginRecord() and endRecord() drawing goes into list, up to
+	// size commands, instead of to the display.  endRecord() returns the
+	// number of commands, or 0 if the list ran out.  Fills are recorded
+	// clipped, with touching fills of the same color merged, so replay()
+	// sends them without any checks, continuing the address window where
+	// it can, in as few transactions as the budget allows.  Coordinates
+	// are kept relative to the screen, and pointers passed to writeRect()
+	// and the like are kept, not their data.  A list may be kept in flash.
+	bool beginRecord(ILI9341_t3_dlcmd_t *list, uint16_t size);
+	uint16_t endRecord(void);
+	void replay(const ILI9341_t3_dlcmd_t *list, uint16_t count);
+
+	// Sprite compositor.  Sprites are layered over a background, either a
+	// screen sized image in writeRect() format or a solid color.
+	// updateSprites() redraws only the boxes that changed since the last
+	// call, the old and new place of every sprite that moved, changed or
+	// was removed, merged where they overlap.  Each box is built a
+	// scanline at a time in a line buffer, background first and then the
+	// sprites in z order, and sent as one window, so nothing flickers and
+	// no framebuffer is needed.  Sprites use screen coordinates and are
+	// drawn only inside the clip rectangle.  Nothing is drawn while a
+	// display list is being recorded.
+	void setSpriteBackground(const uint16_t *pixels, uint16_t color = 0);
+	void addSprite(ILI9341_t3_sprite_t *sprite);
+	void removeSprite(ILI9341_t3_sprite_t *sprite);
+	void updateSprites(void);
+
+	// Save-under for cursors, tooltips and other overlays.  captureUnder()
+	// reads the pixels under an overlay into one of a few slots, before it
+	// is drawn, and returns the slot (-1 if none is free, there is no
+	// memory, nothing to read from, or a display list is being recorded).
+	// Only the part inside the clip rectangle is saved.
+	// restoreUnder() writes them back and frees the slot; without a slot
+	// it restores the latest capture.  Reading costs only the overlay
+	// area, and the UI underneath never needs a redraw.  Slot buffers are
+	// kept until freeUnder().
+	int8_t captureUnder(int16_t x, int16_t y, int16_t w, int16_t h);
+	void restoreUnder(int8_t slot = -1);
+	void freeUnder(void);
+
     void setLandscape(bool l=true);
     void setPortrait(bool p=true)   { setLandscape(!p); }
     bool getLandscape()             { return native_width > native_height; }
@@ -209,6 +491,18 @@ class ILI9341_t3 : public Print
     bool getRGB()                   { return !madctl_bgr; }
 
 	void setRotation(uint8_t r);
+
+	// Every drawing function, and readRect(), takes coordinates relative
+	// to the origin and only touches pixels inside the clip rectangle.
+	// setClipRect() takes the same coordinates and is limited to the
+	// screen; without arguments it clips to the whole screen again.
+	// pushOrigin() moves the origin by dx, dy and saves the previous
+	// origin and clip rectangle for popOrigin(), so widgets can draw in
+	// their own coordinates.  setRotation() resets the clip rectangle.
+	void setClipRect(int16_t x, int16_t y, int16_t w, int16_t h);
+	void setClipRect(void)          { setClipScreen(0, 0, _width, _height); }
+	bool pushOrigin(int16_t dx, int16_t dy);
+	void popOrigin(void);
 	void setScroll(uint16_t offset);
 	void invertDisplay(boolean i);
 	void setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
@@ -273,11 +567,18 @@ class ILI9341_t3 : public Print
 
 	// from Adafruit_GFX.h
 	void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+	// Anti-aliased, edge pixels are blended between color and the known background bg
+	void drawLineAA(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, uint16_t bg);
+	void drawCircleAA(int16_t x0, int16_t y0, int16_t r, uint16_t color, uint16_t bg);
 	void drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color);
 	void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
 	void fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, int16_t delta, uint16_t color);
+	void fillEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t color);
 	void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
 	void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+	void fillPolygon(const ILI9341_t3_point_t *points, uint16_t n, uint16_t color, uint8_t rule = ILI9341_FILL_EVENODD);
+	void drawPolyline(const ILI9341_t3_point_t *points, uint16_t n, uint8_t width, uint16_t color,
+		uint8_t join = ILI9341_JOIN_MITER, uint8_t cap = ILI9341_CAP_BUTT);
 	void drawRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t radius, uint16_t color);
 	void fillRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t radius, uint16_t color);
 	void drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color);
@@ -309,8 +610,30 @@ class ILI9341_t3 : public Print
 	uint16_t measureTextHeight(const char* text, int chars = 0);
 	int16_t strPixelLen(char * str);
 
+	// Run several drawing calls in one SPI transaction.  Batches nest; the
+	// bus is only released by the outermost endBatch(), or between calls
+	// once the transaction has been held longer than the budget.
+	void beginBatch(void) { _batch_depth++; }
+	void endBatch(void) {
+		waitAsyncComplete();
+		if (_batch_depth && --_batch_depth == 0 && _batch_held) {
+			_batch_held = false;
+			releaseSPI();
+			_busOwner[_spi_num] = NULL;
+		}
+	}
+	// Longest time, in microseconds, to hold the SPI bus before letting
+	// other SPI users in.  Long fills are split into transactions of about
+	// this length at the current clock.  0 keeps the bus for as long as
+	// needed, for when the display is the only device on the bus.
+	void setTransactionBudget(uint32_t us) { _transaction_budget = us; }
+
+	const ILI9341_t3_stats_t &getStats() { return _stats; }
+	void resetStats() { memset(&_stats, 0, sizeof(_stats)); }
+
  protected:
         unsigned long _clock = ILI9341_SPICLOCK;
+        unsigned long _clock_read = ILI9341_SPICLOCK_READ;
 	int16_t _width, _height; // Display w/h as modified by current rotation
     int16_t native_width, native_height;
 	int16_t  cursor_x, cursor_y;
@@ -323,10 +646,66 @@ class ILI9341_t3 : public Print
   	uint8_t _cs, _dc;
 	uint8_t pcs_data, pcs_command;
 	uint8_t _miso, _mosi, _sclk;
+	SPIClass *_pspi;
+	uint8_t _spi_num;               // index of _pspi: 0=SPI, 1=SPI1, 2=SPI2
+	uint8_t _fifo_depth;            // transmit FIFO depth, in words
     uint8_t madctl_bgr;
 
+	uint16_t *_pfbtft = NULL;       // framebuffer, _width x _height
+	int16_t _fb_y0 = 0, _fb_y1 = 0;	// screen rows held in _pfbtft
+	uint8_t _use_fbtft = 0;
+	uint8_t _fb_bits = 16;          // 16 for 565 colors, 8 or 4 for palette indices
+	const uint16_t *_fb_palette = NULL;
+	uint32_t _fb_dirty[ILI9341_TILE_ROWS];	// changed tiles, bit n is tile column n
+	uint32_t *_fb_hash = NULL;      // hash of each tile as last sent, see setFrameDiff()
+	bool _fb_hash_valid = false;
+
+	// banded rendering, see beginFrame()
+	uint16_t *_band_buf = NULL;     // one strip, or two for DMA ping-pong
+	uint16_t *_band_saved_fb;       // _pfbtft while a frame is banded
+	uint8_t _band_saved_bits;
+	uint16_t _band_rows = 0;
+	uint16_t _band_bg;
+	bool _fb_banded = false;
+	bool _dl_recording = false;
+	ILI9341_t3_dlcmd_t *_dl_list = NULL;
+	uint16_t _dl_size = 0, _dl_count = 0;
+	// useBands() list and drawing state while recording, see beginRecord()
+	ILI9341_t3_dlcmd_t *_rec_saved_list;
+	uint16_t _rec_saved_size;
+	uint8_t _rec_saved_use_fb;
+	uint32_t _rec_overflows;
+	bool _dl_retained = false;
+
+	// origin and clip rectangle, see setClipRect()
+	int16_t _originx = 0, _originy = 0;
+	int16_t _clipx1 = 0, _clipy1 = 0, _clipx2, _clipy2;	// screen coordinates, x2/y2 exclusive
+	ILI9341_t3_view_t _view_stack[ILI9341_ORIGIN_DEPTH];
+	uint8_t _view_depth = 0;
+
+	// sprite compositor, see updateSprites()
+	ILI9341_t3_sprite_t *_sprites = NULL;	// sorted by z when drawn
+	const uint16_t *_sprite_bg = NULL;
+	uint16_t _sprite_bg_color = 0;
+	int16_t _sprite_x1 = 0, _sprite_y1 = 0, _sprite_x2 = 0, _sprite_y2 = 0;	// area to redraw besides the sprites
+
+	ILI9341_t3_under_t _under[ILI9341_UNDER_SLOTS] = {};
+	bool _tear_pacing = false;
+	uint16_t _under_seq = 0;
+	volatile uint8_t _dma_state = 0;
+	ILI9341_t3_callback _dma_callback = NULL;
+	ILI9341_t3_stats_t _stats = {};
+
+	uint8_t _batch_depth = 0;
+	bool _batch_held = false;       // transaction kept open for the batch
+	static ILI9341_t3 * volatile _busOwner[ILI9341_SPI_BUSES];	// display with its CS low on each bus
+	uint32_t _transaction_budget = ILI9341_TRANSACTION_BUDGET;
+	uint32_t _transaction_clock;
+	uint32_t _transaction_start;
+
 	// add support to allow only one hardware CS (used for dc)
 #if defined(__IMXRT1052__) || defined(__IMXRT1062__)  // Teensy 4.x
+    IMXRT_LPSPI_t *_pimxrt_spi;
     uint32_t _cspinmask;
     volatile uint32_t *_csport;
     uint32_t _spi_tcr_current;
@@ -336,8 +715,39 @@ class ILI9341_t3 : public Print
     uint32_t _tcr_dc_assert;
     uint32_t _tcr_dc_not_assert;
 #else
+    KINETISK_SPI_t *_pkinetisk_spi;
+    uint32_t _fifo_full_test;       // SR TXCTR value meaning the FIFO is full
     uint8_t _cspinmask;
     volatile uint8_t *_csport;
+#endif
+
+#ifdef ILI9341_T3_USE_DMA
+	DMAChannel *_dmatx = NULL;      // allocated by initDMA()
+	const uint16_t *_dma_src;       // NULL when repeating _dma_color
+	uint16_t _dma_color;
+	uint32_t _dma_remaining;        // pixels not yet handed to the DMA
+	static ILI9341_t3 *_dmaActiveDisplay[ILI9341_SPI_BUSES];
+	static void dmaInterrupt(void);
+#if ILI9341_SPI_BUSES > 1
+	static void dmaInterrupt1(void);
+	static void dmaInterrupt2(void);
+#endif
+	void attachDMAInterrupt(void);
+	void process_dma_interrupt(void);
+	bool allocDMAChannel(void);
+	bool initDMA(void);
+	bool startAsync(int16_t x, int16_t y, int16_t w, int16_t h);
+	bool sendNow(int16_t x, int16_t y, int16_t w, int16_t h);
+#if defined(KINETISK)
+	DMASetting _dmasettings[2];
+	uint8_t _dma_buffer;            // next ping-pong half to refill
+	uint8_t _dma_pending;           // halves queued but not yet sent
+	uint32_t _dma_mcr;
+	uint32_t *_dma_pushr = NULL;    // both halves, allocated by initDMA()
+	void fillPushrBuffer(uint8_t i);
+#else
+	void startDMAChunk(void);
+#endif
 #endif
 	uint16_t old_x0=-1, old_x1, old_y0=-1, old_y1;
 	void setAddr(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
@@ -356,6 +766,31 @@ class ILI9341_t3 : public Print
 		}
 	}
 
+	// Where the next pixel will land, when the last write left the GRAM
+	// pointer at the start of row _gram_y of the current window.
+	bool _gram_valid = false;
+	uint16_t _gram_y;
+
+	// Set up the window and start a write of exactly (x1-x0+1)*(y1-y0+1)
+	// pixels.  A write that starts right where the previous one stopped,
+	// with the same columns, needs no CASET/PASET at all and is sent as
+	// Memory Write Continue.  New windows are left open to the bottom of
+	// the screen to make that case common (rows of writeRect, font lines,
+	// stacked fills).
+	void beginWrite(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+	  __attribute__((always_inline)) {
+		if (_gram_valid && y0 == _gram_y && x0 == old_x0 && x1 == old_x1 && y1 <= old_y1) {
+			writecommand_cont(ILI9341_RAMWRC);
+			_stats.ramwr_continue++;
+		} else {
+			setAddr(x0, y0, x1, (y1 < _height) ? _height - 1 : y1);
+			writecommand_cont(ILI9341_RAMWR);
+			_stats.ramwr++;
+		}
+		_gram_y = y1 + 1;
+		_gram_valid = _gram_y <= old_y1;	// otherwise the pointer wrapped
+	}
+
 //----------------------------------------------------------------------
 // Processor Specific stuff
 
@@ -370,23 +805,23 @@ class ILI9341_t3 : public Print
 	void waitFifoNotFull(void) {
     	uint32_t tmp __attribute__((unused));
     	do {
-        	if ((IMXRT_LPSPI4_S.RSR & LPSPI_RSR_RXEMPTY) == 0)  {
-            	tmp = IMXRT_LPSPI4_S.RDR;  // Read any pending RX bytes in
+        	if ((_pimxrt_spi->RSR & LPSPI_RSR_RXEMPTY) == 0)  {
+            	tmp = _pimxrt_spi->RDR;  // Read any pending RX bytes in
             	if (_pending_rx_count) _pending_rx_count--; //decrement count of bytes still levt
         	}
-    	} while ((IMXRT_LPSPI4_S.SR & LPSPI_SR_TDF) == 0) ;
+    	} while ((_pimxrt_spi->SR & LPSPI_SR_TDF) == 0) ;
 	}
 	void waitTransmitComplete(void)  {
 	    uint32_t tmp __attribute__((unused));
 	//    digitalWriteFast(2, HIGH);
 
 	    while (_pending_rx_count) {
-	        if ((IMXRT_LPSPI4_S.RSR & LPSPI_RSR_RXEMPTY) == 0)  {
-	            tmp = IMXRT_LPSPI4_S.RDR;  // Read any pending RX bytes in
+	        if ((_pimxrt_spi->RSR & LPSPI_RSR_RXEMPTY) == 0)  {
+	            tmp = _pimxrt_spi->RDR;  // Read any pending RX bytes in
 	            _pending_rx_count--; //decrement count of bytes still levt
 	        }
 	    }
-	    IMXRT_LPSPI4_S.CR = LPSPI_CR_MEN | LPSPI_CR_RRF;       // Clear RX FIFO
+	    _pimxrt_spi->CR = LPSPI_CR_MEN | LPSPI_CR_RRF;       // Clear RX FIFO
 	//    digitalWriteFast(2, LOW);
 	}
 
@@ -398,72 +833,137 @@ class ILI9341_t3 : public Print
 			_spi_tcr_current = (_spi_tcr_current & ~TCR_MASK) | requested_tcr_state ;
 			// only output when Transfer queue is empty.
 			if (!dc_state_change || !_dcpinmask) {
-				while ((IMXRT_LPSPI4_S.FSR & 0x1f) )	;
-				IMXRT_LPSPI4_S.TCR = _spi_tcr_current;	// update the TCR
+				while ((_pimxrt_spi->FSR & 0x1f) )	;
+				_pimxrt_spi->TCR = _spi_tcr_current;	// update the TCR
 
 			} else {
 				waitTransmitComplete();
 				if (requested_tcr_state & LPSPI_TCR_PCS(3)) DIRECT_WRITE_HIGH(_dcport, _dcpinmask);
 				else DIRECT_WRITE_LOW(_dcport, _dcpinmask);
-				IMXRT_LPSPI4_S.TCR = _spi_tcr_current & ~(LPSPI_TCR_PCS(3) | LPSPI_TCR_CONT);	// go ahead and update TCR anyway?  
+				_pimxrt_spi->TCR = _spi_tcr_current & ~(LPSPI_TCR_PCS(3) | LPSPI_TCR_CONT);	// go ahead and update TCR anyway?  
 
 			}
 		}
 	}
 
-	void beginSPITransaction(uint32_t clock = ILI9341_SPICLOCK) __attribute__((always_inline)) {
-		SPI.beginTransaction(SPISettings(clock, MSBFIRST, SPI_MODE0));
-		if (!_dcport) _spi_tcr_current = IMXRT_LPSPI4_S.TCR; 	// Only if DC is on hardware CS 
+	void acquireSPI(uint32_t clock) __attribute__((always_inline)) {
+		_pspi->beginTransaction(SPISettings(clock, MSBFIRST, SPI_MODE0));
+		if (!_dcport) _spi_tcr_current = _pimxrt_spi->TCR; 	// Only if DC is on hardware CS 
 		if (_csport)
 			DIRECT_WRITE_LOW(_csport, _cspinmask);
 	}
-	void endSPITransaction() __attribute__((always_inline)) {
+	void releaseSPI() __attribute__((always_inline)) {
 		if (_csport)
 			DIRECT_WRITE_HIGH(_csport, _cspinmask);
-		SPI.endTransaction();
+		_pspi->endTransaction();
 	}
 
 	// BUGBUG:: currently assumming we only have CS_0 as valid CS
 	void writecommand_cont(uint8_t c) __attribute__((always_inline)) {
 		maybeUpdateTCR(_tcr_dc_assert | LPSPI_TCR_FRAMESZ(7) /*| LPSPI_TCR_CONT*/);
-		IMXRT_LPSPI4_S.TDR = c;
+		_pimxrt_spi->TDR = c;
 		_pending_rx_count++;	//
+		_stats.fifo_pushes++;
 		waitFifoNotFull();
 	}
 	void writedata8_cont(uint8_t c) __attribute__((always_inline)) {
 		maybeUpdateTCR(_tcr_dc_not_assert | LPSPI_TCR_FRAMESZ(7) | LPSPI_TCR_CONT);
-		IMXRT_LPSPI4_S.TDR = c;
+		_pimxrt_spi->TDR = c;
 		_pending_rx_count++;	//
+		_stats.fifo_pushes++;
 		waitFifoNotFull();
 	}
 	void writedata16_cont(uint16_t d) __attribute__((always_inline)) {
 		maybeUpdateTCR(_tcr_dc_not_assert | LPSPI_TCR_FRAMESZ(15) | LPSPI_TCR_CONT);
-		IMXRT_LPSPI4_S.TDR = d;
+		_pimxrt_spi->TDR = d;
 		_pending_rx_count++;	//
+		_stats.fifo_pushes++;
 		waitFifoNotFull();
 	}
 	void writecommand_last(uint8_t c) __attribute__((always_inline)) {
 		maybeUpdateTCR(_tcr_dc_assert | LPSPI_TCR_FRAMESZ(7));
-		IMXRT_LPSPI4_S.TDR = c;
-//		IMXRT_LPSPI4_S.SR = LPSPI_SR_WCF | LPSPI_SR_FCF | LPSPI_SR_TCF;
+		_pimxrt_spi->TDR = c;
+//		_pimxrt_spi->SR = LPSPI_SR_WCF | LPSPI_SR_FCF | LPSPI_SR_TCF;
 		_pending_rx_count++;	//
+		_stats.fifo_pushes++;
 		waitTransmitComplete();
 	}
 	void writedata8_last(uint8_t c) __attribute__((always_inline)) {
 		maybeUpdateTCR(_tcr_dc_not_assert | LPSPI_TCR_FRAMESZ(7));
-		IMXRT_LPSPI4_S.TDR = c;
-//		IMXRT_LPSPI4_S.SR = LPSPI_SR_WCF | LPSPI_SR_FCF | LPSPI_SR_TCF;
+		_pimxrt_spi->TDR = c;
+//		_pimxrt_spi->SR = LPSPI_SR_WCF | LPSPI_SR_FCF | LPSPI_SR_TCF;
 		_pending_rx_count++;	//
+		_stats.fifo_pushes++;
 		waitTransmitComplete();
 	}
 	void writedata16_last(uint16_t d) __attribute__((always_inline)) {
 		maybeUpdateTCR(_tcr_dc_not_assert | LPSPI_TCR_FRAMESZ(15));
-		IMXRT_LPSPI4_S.TDR = d;
-//		IMXRT_LPSPI4_S.SR = LPSPI_SR_WCF | LPSPI_SR_FCF | LPSPI_SR_TCF;
+		_pimxrt_spi->TDR = d;
+//		_pimxrt_spi->SR = LPSPI_SR_WCF | LPSPI_SR_FCF | LPSPI_SR_TCF;
 		_pending_rx_count++;	//
+		_stats.fifo_pushes++;
 		waitTransmitComplete();
 	}
 
+	// Burst kernel: check the FIFO level once, drain everything received so
+	// far in one go, and return how many words can be pushed without
+	// looking at the status again.
+	uint32_t waitFifoRoom(void) {
+		uint32_t fsr, room;
+		uint32_t tmp __attribute__((unused));
+		do {
+			fsr = _pimxrt_spi->FSR;
+			for (uint32_t n = (fsr >> 16) & 0x1f; n > 0; n--) {
+				tmp = _pimxrt_spi->RDR;
+				if (_pending_rx_count) _pending_rx_count--;
+			}
+			room = _fifo_depth - (fsr & 0x1f);
+		} while ((int32_t)room <= 0);
+		return room;
+	}
+	// Send count pixels of one color.  Runs of at least a FIFO of pixels
+	// go out in pairs as 32 bit frames, which halves the FIFO pushes.
+	// Changing the frame size waits for the FIFO to empty, so shorter runs
+	// stay on 16 bit frames.
+	void writeColor_cont(uint16_t color, uint32_t count) {
+		if (count >= _fifo_depth) {
+			uint32_t pair = ((uint32_t)color << 16) | color;
+			uint32_t pairs = count >> 1;
+			maybeUpdateTCR(_tcr_dc_not_assert | LPSPI_TCR_FRAMESZ(31) | LPSPI_TCR_CONT);
+			do {
+				uint32_t n = waitFifoRoom();
+				if (n > pairs) n = pairs;
+				pairs -= n;
+				_pending_rx_count += n;
+				_stats.fifo_pushes += n;
+				do { _pimxrt_spi->TDR = pair; } while (--n);
+			} while (pairs);
+			count &= 1;
+		}
+		if (!count) return;
+		maybeUpdateTCR(_tcr_dc_not_assert | LPSPI_TCR_FRAMESZ(15) | LPSPI_TCR_CONT);
+		do {
+			uint32_t n = waitFifoRoom();
+			if (n > count) n = count;
+			count -= n;
+			_pending_rx_count += n;
+			_stats.fifo_pushes += n;
+			do { _pimxrt_spi->TDR = color; } while (--n);
+		} while (count);
+	}
+	void writePixels_cont(const uint16_t *pcolors, uint32_t count) {
+		if (!count) return;
+		maybeUpdateTCR(_tcr_dc_not_assert | LPSPI_TCR_FRAMESZ(15) | LPSPI_TCR_CONT);
+		do {
+			uint32_t n = waitFifoRoom();
+			if (n > count) n = count;
+			count -= n;
+			_pending_rx_count += n;
+			_stats.fifo_pushes += n;
+			do { _pimxrt_spi->TDR = *pcolors++; } while (--n);
+		} while (count);
+	}
+
 #else
 // T3.x	
 	//void waitFifoNotFull(void) __attribute__((always_inline)) {
@@ -471,102 +971,362 @@ class ILI9341_t3 : public Print
 		uint32_t sr;
 		uint32_t tmp __attribute__((unused));
 		do {
-			sr = KINETISK_SPI0.SR;
-			if (sr & 0xF0) tmp = KINETISK_SPI0.POPR;  // drain RX FIFO
-		} while ((sr & (15 << 12)) > (3 << 12));
+			sr = _pkinetisk_spi->SR;
+			if (sr & 0xF0) tmp = _pkinetisk_spi->POPR;  // drain RX FIFO
+		} while ((sr & (15 << 12)) > _fifo_full_test);
 	}
 	void waitFifoEmpty(void) {
 		uint32_t sr;
 		uint32_t tmp __attribute__((unused));
 		do {
-			sr = KINETISK_SPI0.SR;
-			if (sr & 0xF0) tmp = KINETISK_SPI0.POPR;  // drain RX FIFO
+			sr = _pkinetisk_spi->SR;
+			if (sr & 0xF0) tmp = _pkinetisk_spi->POPR;  // drain RX FIFO
 		} while ((sr & 0xF0F0) > 0);             // wait both RX & TX empty
 	}
 	void waitTransmitComplete(void) __attribute__((always_inline)) {
 		uint32_t tmp __attribute__((unused));
-		while (!(KINETISK_SPI0.SR & SPI_SR_TCF)) ; // wait until final output done
-		tmp = KINETISK_SPI0.POPR;                  // drain the final RX FIFO word
+		while (!(_pkinetisk_spi->SR & SPI_SR_TCF)) ; // wait until final output done
+		tmp = _pkinetisk_spi->POPR;                  // drain the final RX FIFO word
 	}
 	void waitTransmitComplete(uint32_t mcr) __attribute__((always_inline)) {
 		uint32_t tmp __attribute__((unused));
 		while (1) {
-			uint32_t sr = KINETISK_SPI0.SR;
+			uint32_t sr = _pkinetisk_spi->SR;
 			if (sr & SPI_SR_EOQF) break;  // wait for last transmit
-			if (sr &  0xF0) tmp = KINETISK_SPI0.POPR;
+			if (sr &  0xF0) tmp = _pkinetisk_spi->POPR;
 		}
-		KINETISK_SPI0.SR = SPI_SR_EOQF;
-		SPI0_MCR = mcr;
-		while (KINETISK_SPI0.SR & 0xF0) {
-			tmp = KINETISK_SPI0.POPR;
+		_pkinetisk_spi->SR = SPI_SR_EOQF;
+		_pkinetisk_spi->MCR = mcr;
+		while (_pkinetisk_spi->SR & 0xF0) {
+			tmp = _pkinetisk_spi->POPR;
 		}
 	}
-	void beginSPITransaction(uint32_t clock = ILI9341_SPICLOCK) __attribute__((always_inline)) {
-		SPI.beginTransaction(SPISettings(clock, MSBFIRST, SPI_MODE0));
+	void acquireSPI(uint32_t clock) __attribute__((always_inline)) {
+		_pspi->beginTransaction(SPISettings(clock, MSBFIRST, SPI_MODE0));
 		if (_csport)
 			*_csport  &= ~_cspinmask;
 	}
-	void endSPITransaction() __attribute__((always_inline)) {
+	void releaseSPI() __attribute__((always_inline)) {
 		if (_csport)
 			*_csport |= _cspinmask;
-		SPI.endTransaction();
+		_pspi->endTransaction();
 	}
 
 	void writecommand_cont(uint8_t c) __attribute__((always_inline)) {
-		KINETISK_SPI0.PUSHR = c | (pcs_command << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_CONT;
+		_pkinetisk_spi->PUSHR = c | (pcs_command << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_CONT;
+		_stats.fifo_pushes++;
 		waitFifoNotFull();
 	}
 	void writedata8_cont(uint8_t c) __attribute__((always_inline)) {
-		KINETISK_SPI0.PUSHR = c | (pcs_data << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_CONT;
+		_pkinetisk_spi->PUSHR = c | (pcs_data << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_CONT;
+		_stats.fifo_pushes++;
 		waitFifoNotFull();
 	}
 	void writedata16_cont(uint16_t d) __attribute__((always_inline)) {
-		KINETISK_SPI0.PUSHR = d | (pcs_data << 16) | SPI_PUSHR_CTAS(1) | SPI_PUSHR_CONT;
+		_pkinetisk_spi->PUSHR = d | (pcs_data << 16) | SPI_PUSHR_CTAS(1) | SPI_PUSHR_CONT;
+		_stats.fifo_pushes++;
 		waitFifoNotFull();
 	}
 	void writecommand_last(uint8_t c) __attribute__((always_inline)) {
-		uint32_t mcr = SPI0_MCR;
-		KINETISK_SPI0.PUSHR = c | (pcs_command << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_EOQ;
+		uint32_t mcr = _pkinetisk_spi->MCR;
+		_pkinetisk_spi->PUSHR = c | (pcs_command << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_EOQ;
+		_stats.fifo_pushes++;
 		waitTransmitComplete(mcr);
 	}
 	void writedata8_last(uint8_t c) __attribute__((always_inline)) {
-		uint32_t mcr = SPI0_MCR;
-		KINETISK_SPI0.PUSHR = c | (pcs_data << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_EOQ;
+		uint32_t mcr = _pkinetisk_spi->MCR;
+		_pkinetisk_spi->PUSHR = c | (pcs_data << 16) | SPI_PUSHR_CTAS(0) | SPI_PUSHR_EOQ;
+		_stats.fifo_pushes++;
 		waitTransmitComplete(mcr);
 	}
 	void writedata16_last(uint16_t d) __attribute__((always_inline)) {
-		uint32_t mcr = SPI0_MCR;
-		KINETISK_SPI0.PUSHR = d | (pcs_data << 16) | SPI_PUSHR_CTAS(1) | SPI_PUSHR_EOQ;
+		uint32_t mcr = _pkinetisk_spi->MCR;
+		_pkinetisk_spi->PUSHR = d | (pcs_data << 16) | SPI_PUSHR_CTAS(1) | SPI_PUSHR_EOQ;
+		_stats.fifo_pushes++;
 		waitTransmitComplete(mcr);
 	}
+
+	// Burst kernel: check the FIFO level once, drain everything received so
+	// far in one go, and return how many words can be pushed without
+	// looking at the status again.
+	uint32_t waitFifoRoom(void) {
+		uint32_t sr, room;
+		uint32_t tmp __attribute__((unused));
+		do {
+			sr = _pkinetisk_spi->SR;
+			for (uint32_t n = (sr >> 4) & 15; n > 0; n--) tmp = _pkinetisk_spi->POPR;
+			room = _fifo_depth - ((sr >> 12) & 15);
+		} while ((int32_t)room <= 0);
+		return room;
+	}
+	// SPI0 frames are at most 16 bits, so a run is one push per pixel
+	void writeColor_cont(uint16_t color, uint32_t count) {
+		uint32_t word = color | (pcs_data << 16) | SPI_PUSHR_CTAS(1) | SPI_PUSHR_CONT;
+		while (count) {
+			uint32_t n = waitFifoRoom();
+			if (n > count) n = count;
+			count -= n;
+			_stats.fifo_pushes += n;
+			do { _pkinetisk_spi->PUSHR = word; } while (--n);
+		}
+	}
+	void writePixels_cont(const uint16_t *pcolors, uint32_t count) {
+		uint32_t cont = (pcs_data << 16) | SPI_PUSHR_CTAS(1) | SPI_PUSHR_CONT;
+		while (count) {
+			uint32_t n = waitFifoRoom();
+			if (n > count) n = count;
+			count -= n;
+			_stats.fifo_pushes += n;
+			do { _pkinetisk_spi->PUSHR = *pcolors++ | cont; } while (--n);
+		}
+	}
 #endif
+	// Inside beginBatch()/endBatch() the transaction opened by the first
+	// primitive is kept across calls, until it has been held for
+	// _transaction_budget microseconds.  It is only reused at the clock it
+	// was opened with, so reads, and writes after a setClock(), get a
+	// transaction of their own.
+	// A display sharing the bus may still have its CS low, sending by DMA
+	// or holding a batch; its transaction has to end before ours starts.
+	void beginSPITransaction(uint32_t clock = ILI9341_SPICLOCK) __attribute__((always_inline)) {
+		ILI9341_t3 *owner = _busOwner[_spi_num];
+		if (owner && (owner != this)) owner->yieldBus();
+		if (_dma_state & ILI9341_DMA_ACTIVE) waitAsyncComplete();
+		if (_batch_held) {
+			if (clock == _transaction_clock) return;
+			_batch_held = false;
+			releaseSPI();
+		}
+		acquireSPI(clock);
+		_busOwner[_spi_num] = this;
+		_transaction_clock = clock;
+		_transaction_start = micros();
+	}
+	void endSPITransaction() __attribute__((always_inline)) {
+		if (_batch_depth && _transaction_clock == _clock) {
+			_batch_held = !_transaction_budget
+				|| (micros() - _transaction_start) < _transaction_budget;
+			if (_batch_held) return;
+		}
+		releaseSPI();
+		_busOwner[_spi_num] = NULL;
+	}
+	// Finish this display's DMA and let go of its batch transaction, for
+	// another display on the same bus
+	void yieldBus(void) {
+		waitAsyncComplete();
+		if (_batch_held) {
+			_batch_held = false;
+			releaseSPI();
+			_busOwner[_spi_num] = NULL;
+		}
+	}
+
+	// Rows of w pixels that go out within the transaction budget at the
+	// current clock (16 bits per pixel), at least 1.  Without a budget the
+	// whole h rows are sent in one transaction.
+	uint32_t rowsPerTransaction(int16_t w, int16_t h) {
+		if (!_transaction_budget) return h;
+		uint32_t rows = ((uint64_t)_clock * _transaction_budget) / (16000000ull * w);
+		return rows ? rows : 1;
+	}
+
+	// Shapes sent in one transaction count their pixels against this
+	// many, see spendBudget()
+	uint32_t budgetPixels(void) {
+		return _transaction_budget ? rowsPerTransaction(1, 1) : 0xFFFFFFFF;
+	}
+	// Count n more pixels of a shape, first ending the transaction and
+	// starting a new one when they would go over budget
+	void spendBudget(uint32_t &pixels, uint32_t budget, uint32_t n) {
+		if (_use_fbtft) return;
+		if (pixels && (pixels + n > budget)) {
+			writecommand_last(ILI9341_NOP);
+			endSPITransaction();
+			beginSPITransaction(_clock);
+			pixels = 0;
+		}
+		pixels += n;
+	}
+
+	// count must be at least 1
+	void writeColor_last(uint16_t color, uint32_t count) __attribute__((always_inline)) {
+		writeColor_cont(color, count - 1);
+		writedata16_last(color);
+	}
+	void writePixels_last(const uint16_t *pcolors, uint32_t count) __attribute__((always_inline)) {
+		writePixels_cont(pcolors, count - 1);
+		writedata16_last(pcolors[count - 1]);
+	}
+	// Flag the tiles under an already clipped rectangle as changed
+	void fbMarkDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+		uint32_t cols = (2u << ((x + w - 1) >> ILI9341_TILE_SHIFT)) - (1u << (x >> ILI9341_TILE_SHIFT));
+		for (int16_t r = y >> ILI9341_TILE_SHIFT; r <= ((y + h - 1) >> ILI9341_TILE_SHIFT); r++) {
+			_fb_dirty[r] |= cols;
+		}
+	}
+	// The fb helpers take screen coordinates.  The buffer holds rows
+	// _fb_y0 up to _fb_y1, all of them unless rendering a band.
+	void fbPixel(int16_t x, int16_t y, uint16_t color) __attribute__((always_inline)) {
+		if (_dl_recording) {
+			dlAdd(ILI9341_DL_FILL, x, y, 1, 1, color);
+			return;
+		}
+		if ((y < _fb_y0) || (y >= _fb_y1)) return;
+		if (_fb_bits == 16) {
+			_pfbtft[(y - _fb_y0) * _width + x] = color;
+		} else {
+			fbIndexedStore(x, y, &color, 1);
+		}
+		_fb_dirty[y >> ILI9341_TILE_SHIFT] |= 1u << (x >> ILI9341_TILE_SHIFT);
+	}
+	// Fill a rectangle of the framebuffer, clipped to the clip rectangle
+	void fbFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+		const int16_t y0 = (_clipy1 > _fb_y0) ? _clipy1 : _fb_y0;
+		const int16_t y1 = (_clipy2 < _fb_y1) ? _clipy2 : _fb_y1;
+		if(x < _clipx1) {	w += x - _clipx1; x = _clipx1; 	}
+		if(y < y0) {	h += y - y0; y = y0; 	}
+		if((x + w) > _clipx2)  w = _clipx2  - x;
+		if((y + h) > y1) h = y1 - y;
+		if((w <= 0) || (h <= 0)) return;
+		if (_dl_recording) {
+			dlAdd(ILI9341_DL_FILL, x, y, w, h, color);
+			return;
+		}
+		fbMarkDirty(x, y, w, h);
+		if (_fb_bits != 16) {
+			fbIndexedFill(x, y, w, h, color);
+			return;
+		}
+		uint16_t *p = _pfbtft + (y - _fb_y0) * _width + x;
+		for (; h > 0; h--) {
+			for (int16_t i = 0; i < w; i++) p[i] = color;
+			p += _width;
+		}
+	}
+	// Copy a w x h block of pixels into the framebuffer, clipped to the
+	// clip rectangle
+	void fbWriteRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors) {
+		if (_dl_recording) {
+			ILI9341_t3_dlcmd_t *cmd = dlAdd(ILI9341_DL_WRITE, x, y, w, h, 0);
+			if (cmd) cmd->pixels = pcolors;
+			return;
+		}
+		const int16_t top = (_clipy1 > _fb_y0) ? _clipy1 : _fb_y0;
+		const int16_t bottom = (_clipy2 < _fb_y1) ? _clipy2 : _fb_y1;
+		int16_t x0 = (x < _clipx1) ? _clipx1 - x : 0, y0 = (y < top) ? top - y : 0;
+		int16_t x1 = ((x + w) > _clipx2) ? _clipx2 - x : w;
+		int16_t y1 = ((y + h) > bottom) ? bottom - y : h;
+		if ((x0 >= x1) || (y0 >= y1)) return;
+		fbMarkDirty(x + x0, y + y0, x1 - x0, y1 - y0);
+		for (int16_t j = y0; j < y1; j++) {
+			const uint16_t *src = pcolors + j * w;
+			if (_fb_bits != 16) {
+				fbIndexedStore(x + x0, y + j, src + x0, x1 - x0);
+				continue;
+			}
+			uint16_t *p = _pfbtft + (y + j - _fb_y0) * _width + x;
+			for (int16_t i = x0; i < x1; i++) p[i] = src[i];
+		}
+	}
+	// Read a block back from the framebuffer, pixels outside it are 0
+	void fbReadRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors) {
+		for (int16_t j = y; j < y + h; j++) {
+			for (int16_t i = x; i < x + w; i++) {
+				if (_dl_recording || (i < 0) || (i >= _width) || (j < _fb_y0) || (j >= _fb_y1)) {
+					*pcolors++ = 0;
+				} else {
+					*pcolors++ = (_fb_bits == 16) ? _pfbtft[(j - _fb_y0) * _width + i] : fbIndexedLoad(i, j);
+				}
+			}
+		}
+	}
+	// True when a rectangle in origin coordinates misses the clip rectangle
+	bool clipReject(int16_t x, int16_t y, int16_t w, int16_t h) {
+		x += _originx;
+		y += _originy;
+		return (x >= _clipx2) || (y >= _clipy2) || ((x + w) <= _clipx1) || ((y + h) <= _clipy1);
+	}
+	void setClipScreen(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+	// HLine, VLine, Rect and Pixel take screen coordinates
 	void HLine(int16_t x, int16_t y, int16_t w, uint16_t color)
 	  __attribute__((always_inline)) {
-	  	if((x >= _width) || (y >= _height) || (y < 0)) return;
-		if(x < 0) {	w += x; x = 0; 	}
-		if((x+w-1) >= _width)  w = _width-x;
+	  	if((x >= _clipx2) || (y >= _clipy2) || (y < _clipy1)) return;
+		if(x < _clipx1) {	w += x - _clipx1; x = _clipx1; 	}
+		if((x+w) > _clipx2)  w = _clipx2-x;
+		if(w <= 0) return;
+		if (_use_fbtft) {
+			fbFillRect(x, y, w, 1, color);
+			return;
+		}
 
-		setAddr(x, y, x+w-1, y);
-		writecommand_cont(ILI9341_RAMWR);
-		do { writedata16_cont(color); } while (--w > 0);
+		beginWrite(x, y, x+w-1, y);
+		writeColor_cont(color, w);
 	}
 	void VLine(int16_t x, int16_t y, int16_t h, uint16_t color)
 	  __attribute__((always_inline)) {
-		if((x >= _width) || (x < 0) || (y >= _height)) return;
-		if(y < 0) {	h += y; y = 0; 	}
-		if((y+h-1) >= _height) h = _height-y;
-		setAddr(x, y, x, y+h-1);
-		writecommand_cont(ILI9341_RAMWR);
-		do { writedata16_cont(color); } while (--h > 0);
+		if((x >= _clipx2) || (x < _clipx1) || (y >= _clipy2)) return;
+		if(y < _clipy1) {	h += y - _clipy1; y = _clipy1; 	}
+		if((y+h) > _clipy2) h = _clipy2-y;
+		if(h <= 0) return;
+		if (_use_fbtft) {
+			fbFillRect(x, y, 1, h, color);
+			return;
+		}
+		beginWrite(x, y, x, y+h-1);
+		writeColor_cont(color, h);
+	}
+	void Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+	  __attribute__((always_inline)) {
+		if((x >= _clipx2) || (y >= _clipy2)) return;
+		if(x < _clipx1) {	w += x - _clipx1; x = _clipx1; 	}
+		if(y < _clipy1) {	h += y - _clipy1; y = _clipy1; 	}
+		if((x + w) > _clipx2)  w = _clipx2  - x;
+		if((y + h) > _clipy2) h = _clipy2 - y;
+		if((w <= 0) || (h <= 0)) return;
+		if (_use_fbtft) {
+			fbFillRect(x, y, w, h, color);
+			return;
+		}
+		beginWrite(x, y, x+w-1, y+h-1);
+		writeColor_cont(color, (uint32_t)w * h);
 	}
 	void Pixel(int16_t x, int16_t y, uint16_t color)
 	  __attribute__((always_inline)) {
-		if((x >= _width) || (x < 0) || (y >= _height) || (y < 0)) return;
-		setAddr(x, y, x, y);
-		writecommand_cont(ILI9341_RAMWR);
+		if((x >= _clipx2) || (x < _clipx1) || (y >= _clipy2) || (y < _clipy1)) return;
+		if (_use_fbtft) {
+			fbPixel(x, y, color);
+			return;
+		}
+		beginWrite(x, y, x, y);
 		writedata16_cont(color);
 	}
-	void drawFontBits(uint32_t bits, uint32_t numbits, uint32_t x, uint32_t y, uint32_t repeat);
+	void aaStrip(bool steep, int16_t x, int16_t y, int16_t n, const uint16_t *colors, bool reverse);
+	void aaRun(bool steep, int16_t major, int16_t minor, int16_t n, const uint16_t *colors);
+	void aaCircleRun(int16_t x0, int16_t y0, int16_t xs, int16_t xe, int16_t d, const uint16_t *colors);
+	void spanAdd(ILI9341_t3_spans_t &spans, int16_t x, int16_t y, int16_t w);
+	void spanConvex(ILI9341_t3_spans_t &spans, const float *px, const float *py, uint8_t n);
+	void spanDisc(ILI9341_t3_spans_t &spans, float cx, float cy, float r);
+	void spanFlush(ILI9341_t3_spans_t &spans);
+	void circleRun(int16_t x0, int16_t y0, int16_t xs, int16_t xe, int16_t y, uint16_t color);
+	void circleCorners(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color);
+	void fillColumnSpans(int16_t cx0, int16_t cx1, int16_t cy0, int16_t cy1, const int16_t *hh, int16_t n, uint16_t color);
+	void drawFontBits(uint32_t bits, uint32_t numbits, int32_t x, int32_t y, uint32_t repeat);
+	void writeRectPaletted(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels, const uint16_t *palette, uint8_t bits);
+	void sendPaletted(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels, uint32_t rowbytes, int16_t first, const uint16_t *palette, uint8_t bits);
+	void readRectScreen(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors);
+	bool verifyClock(uint32_t seed);
+	void fbUpdateRect(int16_t x, int16_t y, int16_t w, int16_t h);
+	uint32_t fbHashTile(int16_t x, int16_t y, int16_t w, int16_t h);
+	void fbIndexedFill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t index);
+	void fbIndexedStore(int16_t x, int16_t y, const uint16_t *indices, int16_t n);
+	uint16_t fbIndexedLoad(int16_t x, int16_t y);
+	ILI9341_t3_dlcmd_t *dlAdd(uint8_t op, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+	void dlReplay(const ILI9341_t3_dlcmd_t *cmd, uint16_t count);
+	void fbDiffDirty(void);
+	void waitScanLine(int16_t y, int16_t h);
+	void composeSpriteRow(uint16_t *line, int16_t x, int16_t w, int16_t y);
+	void sendSpriteBox(int16_t x, int16_t y, int16_t w, int16_t h);
 };
 
 // To avoid conflict when also using Adafruit_GFX or any Adafruit library
@@ -9,18 +9,19 @@ class BaseAnimation {
 public:
 	BaseAnimation(){};
 
-	virtual void init( ILI9341_t3 tft );
+	virtual void init( ILI9341_t3 &tft );
 	virtual uint_fast16_t bgColor( void );
-	virtual void reset( ILI9341_t3 tft );
+	virtual void reset( ILI9341_t3 &tft );
 	virtual String title();
 
 	virtual boolean willForceTransition( void );
 	virtual boolean forceTransitionNow( void );
+	virtual boolean usesFrameBuffer( void );
 
-	virtual void perFrame( ILI9341_t3 tft, FrameParams frameParams );
+	virtual void perFrame( ILI9341_t3 &tft, FrameParams frameParams );
 };
 
-void BaseAnimation::init( ILI9341_t3 tft ) {
+void BaseAnimation::init( ILI9341_t3 &tft ) {
 	// Extend me
 }
 
@@ -29,7 +30,7 @@ uint_fast16_t BaseAnimation::bgColor( void ) {
 	return 0xf81f;	// Everyone loves magenta
 }
 
-void BaseAnimation::reset( ILI9341_t3 tft ) {
+void BaseAnimation::reset( ILI9341_t3 &tft ) {
 	// Extend me
 }
 
@@ -46,7 +47,11 @@ boolean BaseAnimation::forceTransitionNow( void ) {
 	return false;	// Default: SuperTFT will transition animations automatically
 }
 
-void BaseAnimation::perFrame( ILI9341_t3 tft, FrameParams frameParams ) {
+boolean BaseAnimation::usesFrameBuffer( void ) {
+	return false;	// Default: draw straight to the screen
+}
+
+void BaseAnimation::perFrame( ILI9341_t3 &tft, FrameParams frameParams ) {
 	// Extend me
 }
 
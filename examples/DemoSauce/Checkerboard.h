@@ -21,17 +21,18 @@ class Checkerboard : public BaseAnimation {
 public:
 	Checkerboard() : BaseAnimation() {};
 
-	void init( ILI9341_t3 tft );
+	void init( ILI9341_t3 &tft );
 	uint_fast16_t bgColor( void );
 	String title();
-	void perFrame( ILI9341_t3 tft, FrameParams frameParams );
+	boolean usesFrameBuffer( void );
+	void perFrame( ILI9341_t3 &tft, FrameParams frameParams );
 
 private:
   float _phase = 0;
   uint_fast16_t _bgColor;
 };
 
-void Checkerboard::init( ILI9341_t3 tft ) {
+void Checkerboard::init( ILI9341_t3 &tft ) {
   _bgColor = tft.color565( 0xff, 0xbb, 0xbb );
 }
 
@@ -43,7 +44,12 @@ String Checkerboard::title() {
 	return "Checkerboard";
 }
 
-void Checkerboard::perFrame( ILI9341_t3 tft, FrameParams frameParams ) {
+// Redraws every pixel each frame, the frame diff only sends what changed
+boolean Checkerboard::usesFrameBuffer( void ) {
+	return true;
+}
+
+void Checkerboard::perFrame( ILI9341_t3 &tft, FrameParams frameParams ) {
   int_fast16_t w = (int_fast16_t)tft.width();
   int_fast16_t h = (int_fast16_t)tft.height();
 
@@ -145,6 +145,7 @@ void setup() {
 
   tft.setRotation( 3 ); // ribbon cable on left
   tft.setScroll( 0 );
+  tft.setFrameDiff( true );  // for the framebuffer animations that redraw everything
 
   // Populate anims in the order you want them to display.
   BaseAnimation* ANIMS_TEMP[] = {
@@ -197,7 +198,10 @@ void startAnimation( BaseAnimation *newAnim ) {
   isTransition = false;
 
   activeAnim = newAnim;
+  // Falls back to drawing on the screen if there is no RAM for it
+  tft.useFrameBuffer( activeAnim->usesFrameBuffer() );
   tft.fillScreen( activeAnim->bgColor() );
+  tft.updateScreen();
   tft.setScroll( 0 );
   activeAnim->reset( tft );
 
@@ -220,6 +224,7 @@ void startAnimation( BaseAnimation *newAnim ) {
     }
 
     frameCount = 0;
+    tft.resetStats();
   }
 }
 
@@ -245,7 +250,11 @@ void loop() {
   frameParams.audioPeak = min( (uint_fast16_t)frameParams.audioPeak, (uint_fast16_t)511 );
 
   if( !isTransition ) {
+    // Draw the whole frame in one SPI transaction
+    tft.beginBatch();
     activeAnim->perFrame( tft, frameParams );
+    tft.updateScreen();  // does nothing without a framebuffer
+    tft.endBatch();
     animTimeLeft -= elapsed;
 
     if( DO_BENCHMARKS ) frameCount++;
@@ -264,6 +273,7 @@ void loop() {
       // If the transition has not started yet, then start it.
       if( !isTransition ) {
         isTransition = true;
+        tft.useFrameBuffer( false );  // transitions draw over the last frame
 
         nextAnim = anims[ (getActiveAnimIndex() + 1) % animCount ];
 
@@ -326,11 +336,22 @@ void loop() {
           } else {
             Serial.println("");
           }
+
+          if( activeAnim->usesFrameBuffer() ) {
+            // Only the tiles that changed were sent to the screen
+            const ILI9341_t3_stats_t &stats = tft.getStats();
+            Serial.print("Framebuffer KB sent: ");
+            Serial.print( stats.fb_bytes_sent / 1024 );
+            Serial.print("  skipped: ");
+            Serial.println( stats.fb_bytes_avoided / 1024 );
+          }
         }
       }
 
       // After the transition ends, advance to the next animation
+      tft.beginBatch();
       activeTransition->perFrame( tft, frameParams );
+      tft.endBatch();
       if( activeTransition->isComplete() ) {
         startAnimation( nextAnim );
       }
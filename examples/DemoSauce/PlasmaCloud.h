@@ -23,10 +23,10 @@ class PlasmaCloud : public BaseAnimation {
 public:
 	PlasmaCloud() : BaseAnimation() {};
 
-	void init( ILI9341_t3 tft );
+	void init( ILI9341_t3 &tft );
 	uint_fast16_t bgColor( void );
 	String title();
-	void perFrame( ILI9341_t3 tft, FrameParams frameParams );
+	void perFrame( ILI9341_t3 &tft, FrameParams frameParams );
 
 private:
 	float _phase = 0;
@@ -35,7 +35,7 @@ private:
   uint_fast16_t _bgColor;
 };
 
-void PlasmaCloud::init( ILI9341_t3 tft ) {
+void PlasmaCloud::init( ILI9341_t3 &tft ) {
 	_bgColor = tft.color565( 0x77, 0, 0xcc );
 
   float w = (float)tft.width();
@@ -64,7 +64,7 @@ String PlasmaCloud::title() {
 	return "PlasmaCloud";
 }
 
-void PlasmaCloud::perFrame( ILI9341_t3 tft, FrameParams frameParams ) {
+void PlasmaCloud::perFrame( ILI9341_t3 &tft, FrameParams frameParams ) {
   uint_fast16_t w = (int_fast16_t)tft.width();
   uint_fast16_t h = (int_fast16_t)tft.height();
 
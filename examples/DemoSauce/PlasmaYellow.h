@@ -16,10 +16,11 @@ class PlasmaYellow : public BaseAnimation {
 public:
 	PlasmaYellow() : BaseAnimation() {};
 
-	void init( ILI9341_t3 tft );
+	void init( ILI9341_t3 &tft );
 	uint_fast16_t bgColor( void );
 	String title();
-	void perFrame( ILI9341_t3 tft, FrameParams frameParams );
+	boolean usesFrameBuffer( void );
+	void perFrame( ILI9341_t3 &tft, FrameParams frameParams );
 
 private:
   float _phase = 0;
@@ -27,7 +28,7 @@ private:
   uint_fast16_t _bgColor;
 };
 
-void PlasmaYellow::init( ILI9341_t3 tft ) {
+void PlasmaYellow::init( ILI9341_t3 &tft ) {
   _bgColor = tft.color565( 0xff, 0xff, 0 );
 }
 
@@ -39,7 +40,12 @@ String PlasmaYellow::title() {
 	return "PlasmaYellow";
 }
 
-void PlasmaYellow::perFrame( ILI9341_t3 tft, FrameParams frameParams ) {
+// Redraws every pixel each frame, the frame diff only sends what changed
+boolean PlasmaYellow::usesFrameBuffer( void ) {
+	return true;
+}
+
+void PlasmaYellow::perFrame( ILI9341_t3 &tft, FrameParams frameParams ) {
   int_fast16_t w = (int_fast16_t)tft.width();
   int_fast16_t h = (int_fast16_t)tft.height();
 
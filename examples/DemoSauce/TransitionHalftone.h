@@ -17,9 +17,9 @@ class TransitionHalftone : public BaseTransition {
 public:
 	TransitionHalftone() : BaseTransition() {};
 
-  void init( ILI9341_t3 tft );
-	void restart( ILI9341_t3 tft, uint_fast16_t color );
-	void perFrame( ILI9341_t3 tft, FrameParams frameParams );
+  void init( ILI9341_t3 &tft );
+	void restart( ILI9341_t3 &tft, uint_fast16_t color );
+	void perFrame( ILI9341_t3 &tft, FrameParams frameParams );
   boolean isComplete();
 
 private:
@@ -28,11 +28,11 @@ private:
   boolean _isComplete = false;
 };
 
-void TransitionHalftone::init( ILI9341_t3 tft ) {
+void TransitionHalftone::init( ILI9341_t3 &tft ) {
 
 }
 
-void TransitionHalftone::restart( ILI9341_t3 tft, uint_fast16_t inColor ) {
+void TransitionHalftone::restart( ILI9341_t3 &tft, uint_fast16_t inColor ) {
   //uint_fast16_t w = tft.width();
   //uint_fast16_t h = tft.height();
 	_phase = 0;
@@ -40,7 +40,7 @@ void TransitionHalftone::restart( ILI9341_t3 tft, uint_fast16_t inColor ) {
   _isComplete = false;
 }
 
-void TransitionHalftone::perFrame( ILI9341_t3 tft, FrameParams frameParams ) {
+void TransitionHalftone::perFrame( ILI9341_t3 &tft, FrameParams frameParams ) {
   uint_fast16_t w = (uint_fast16_t)tft.width();
   uint_fast16_t h = (uint_fast16_t)tft.height();
 	uint_fast16_t w_2 = (w>>1);
@@ -15,10 +15,11 @@ class TriangleWeb : public BaseAnimation {
 public:
 	TriangleWeb() : BaseAnimation() {};
 
-	void init( ILI9341_t3 tft );
+	void init( ILI9341_t3 &tft );
 	uint_fast16_t bgColor( void );
 	String title();
-	void perFrame( ILI9341_t3 tft, FrameParams frameParams );
+	boolean usesFrameBuffer( void );
+	void perFrame( ILI9341_t3 &tft, FrameParams frameParams );
 
 private:
   Point getWebPoint( uint_fast8_t i, uint_fast8_t j, float phase );
@@ -29,7 +30,7 @@ private:
   uint_fast16_t _bgColor;
 };
 
-void TriangleWeb::init( ILI9341_t3 tft ) {
+void TriangleWeb::init( ILI9341_t3 &tft ) {
   uint_fast16_t w = tft.width();
   uint_fast16_t h = tft.height();
   //tft.fillRect( 0, 0, w, h, 0x0 );
@@ -48,6 +49,11 @@ String TriangleWeb::title() {
 	return "TriangleWeb";
 }
 
+// Lots of overlapping lines: build the frame in RAM, show it all at once
+boolean TriangleWeb::usesFrameBuffer( void ) {
+	return true;
+}
+
 Point TriangleWeb::getWebPoint( uint_fast8_t i, uint_fast8_t j, float phase ) {
   uint_fast8_t idx = j*_ptsAcross + i;
   uint_fast8_t rando = (idx ^ 37);
@@ -58,7 +64,7 @@ Point TriangleWeb::getWebPoint( uint_fast8_t i, uint_fast8_t j, float phase ) {
    };
 }
 
-void TriangleWeb::perFrame( ILI9341_t3 tft, FrameParams frameParams ) {
+void TriangleWeb::perFrame( ILI9341_t3 &tft, FrameParams frameParams ) {
   //uint_fast16_t w = tft.width();
   //uint_fast16_t h = tft.height();
 
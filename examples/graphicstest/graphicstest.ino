@@ -31,6 +31,8 @@ void setup() {
 // the default value is 30Mhz, but most ILI9341 displays
 // can handle at least 60Mhz and as much as 100Mhz
 //  tft.setClock(60000000);
+// or let the library find the fastest clock your wiring handles
+//  tft.calibrateClock();
   tft.fillScreen(ILI9341_BLACK);
   tft.setTextColor(ILI9341_YELLOW);
   tft.setTextSize(2);
@@ -52,12 +54,30 @@ void setup() {
   x = tft.readcommand8(ILI9341_RDSELFDIAG);
   Serial.print("Self Diagnostic: 0x"); Serial.println(x, HEX); 
   
+  // needs MISO connected to read the display back
+  Serial.print(F("Async writes match       "));
+  Serial.println(testAsyncMatchesSync() ? "yes" : "NO");
+
   Serial.println(F("Benchmark                Time (microseconds)"));
 
   Serial.print(F("Screen fill              "));
   Serial.println(testFillScreen());
   delay(200);
 
+  Serial.print(F("Solid fill pushes/pixel  "));
+  Serial.println(testFillPushes(), 3);
+  delay(200);
+
+  Serial.print(F("Odd 3x3 fills            "));
+  Serial.println(testOddFills());
+  Serial.print(F("Odd fill pushes/pixel    "));
+  Serial.println((float)tft.getStats().fifo_pushes / (tft.width() / 3 * 3 * (tft.height() / 3 * 3)), 3);
+  delay(200);
+
+  Serial.print(F("writeRect cycles/pixel   "));
+  Serial.println(testWriteRectCycles(), 1);
+  delay(200);
+
   Serial.print(F("Text                     "));
   Serial.println(testText());
   delay(600);
@@ -89,6 +109,14 @@ void setup() {
   Serial.println(testCircles(10, ILI9341_WHITE));
   delay(200);
 
+  Serial.print(F("Circles (42 per frame)   "));
+  Serial.println(testCircleFrames(ILI9341_GREEN));
+  delay(200);
+
+  Serial.print(F("Circle (radiating)       "));
+  Serial.println(testRadiatingCircle(ILI9341_CYAN));
+  delay(200);
+
   Serial.print(F("Triangles (outline)      "));
   Serial.println(testTriangles());
   delay(200);
@@ -118,6 +146,37 @@ void loop(void) {
   }
 }
 
+// Draws the same block with writeRect and writeRectAsync, and with
+// fillRect and fillRectAsync, then reads both copies back and compares them
+#define CHECK_SIZE 32
+uint16_t checkPixels[CHECK_SIZE * CHECK_SIZE];
+uint16_t checkSync[CHECK_SIZE * CHECK_SIZE];
+uint16_t checkAsync[CHECK_SIZE * CHECK_SIZE];
+
+bool testAsyncMatchesSync() {
+  bool match = true;
+
+  for (int i = 0; i < CHECK_SIZE * CHECK_SIZE; i++) {
+    checkPixels[i] = i * 2731;
+  }
+  tft.fillScreen(ILI9341_BLACK);
+  tft.writeRect(0, 0, CHECK_SIZE, CHECK_SIZE, checkPixels);
+  tft.writeRectAsync(CHECK_SIZE, 0, CHECK_SIZE, CHECK_SIZE, checkPixels);
+  tft.waitAsyncComplete();
+  tft.readRect(0, 0, CHECK_SIZE, CHECK_SIZE, checkSync);
+  tft.readRect(CHECK_SIZE, 0, CHECK_SIZE, CHECK_SIZE, checkAsync);
+  if (memcmp(checkSync, checkAsync, sizeof(checkSync))) match = false;
+
+  tft.fillRect(0, CHECK_SIZE, CHECK_SIZE, CHECK_SIZE, ILI9341_ORANGE);
+  tft.fillRectAsync(CHECK_SIZE, CHECK_SIZE, CHECK_SIZE, CHECK_SIZE, ILI9341_ORANGE);
+  tft.waitAsyncComplete();
+  tft.readRect(0, CHECK_SIZE, CHECK_SIZE, CHECK_SIZE, checkSync);
+  tft.readRect(CHECK_SIZE, CHECK_SIZE, CHECK_SIZE, CHECK_SIZE, checkAsync);
+  if (memcmp(checkSync, checkAsync, sizeof(checkSync))) match = false;
+
+  return match;
+}
+
 unsigned long testFillScreen() {
   unsigned long start = micros();
   tft.fillScreen(ILI9341_BLACK);
@@ -128,6 +187,40 @@ unsigned long testFillScreen() {
   return micros() - start;
 }
 
+// SPI FIFO words written per pixel for a full screen fill.  This is
+// 1.0 when every pixel is its own 16 bit frame, and about 0.5 on
+// Teensy 4 where solid runs go out as 32 bit pixel pairs.
+float testFillPushes() {
+  tft.resetStats();
+  tft.fillScreen(ILI9341_BLACK);
+  return (float)tft.getStats().fifo_pushes / (tft.width() * tft.height());
+}
+
+// Tile the screen with 3x3 fills: short odd runs, which should stream as
+// 16 bit frames without stopping to change the frame size
+unsigned long testOddFills() {
+  int w = tft.width() / 3 * 3, h = tft.height() / 3 * 3;
+  tft.resetStats();
+  unsigned long start = micros();
+  for (int y = 0; y < h; y += 3) {
+    for (int x = 0; x < w; x += 3) {
+      tft.fillRect(x, y, 3, 3, ((x ^ y) & 4) ? ILI9341_RED : ILI9341_BLUE);
+    }
+  }
+  return micros() - start;
+}
+
+// CPU cycles spent per pixel pushing a full screen of writeRect rows
+float testWriteRectCycles() {
+  static uint16_t row[320];
+  int w = tft.width(), h = tft.height();
+  for (int x = 0; x < w; x++) row[x] = tft.color565(x, x, 255 - x);
+  unsigned long start = micros();
+  for (int y = 0; y < h; y++) tft.writeRect(0, y, w, 1, row);
+  unsigned long t = micros() - start;
+  return (float)t * (F_CPU / 1000000) / (w * h);
+}
+
 unsigned long testText() {
   tft.fillScreen(ILI9341_BLACK);
   unsigned long start = micros();
@@ -316,6 +409,44 @@ unsigned long testCircles(uint8_t radius, uint16_t color) {
   return micros() - start;
 }
 
+// 42 small circles moved and redrawn for 20 frames, like DemoSauce's Cube3D
+unsigned long testCircleFrames(uint16_t color) {
+  unsigned long start;
+  int           frame, i, x, y, r,
+                cx = tft.width()  / 2,
+                cy = tft.height() / 2;
+
+  tft.fillScreen(ILI9341_BLACK);
+  start = micros();
+  for(frame=0; frame<20; frame++) {
+    for(i=0; i<42; i++) {
+      x = cx + ((i % 7) - 3) * 24 + frame;
+      y = cy + ((i / 7) - 3) * 24;
+      r = 3 + (i % 5);
+      tft.drawCircle(x - 1, y, r, ILI9341_BLACK);
+      tft.drawCircle(x, y, r, color);
+    }
+  }
+
+  return micros() - start;
+}
+
+// One large circle growing outward each frame, like DemoSauce's Sphere3D
+unsigned long testRadiatingCircle(uint16_t color) {
+  unsigned long start;
+  int           i, r = min(tft.width(), tft.height()) / 4,
+                cx = tft.width()  / 2,
+                cy = tft.height() / 2;
+
+  tft.fillScreen(ILI9341_BLACK);
+  start = micros();
+  for(i=0; i<48; i++) {
+    tft.drawCircle(cx, cy, r + (i % 12), color);
+  }
+
+  return micros() - start;
+}
+
 unsigned long testTriangles() {
   unsigned long start;
   int           n, i, cx = tft.width()  / 2 - 1,
@@ -66,21 +66,9 @@ void loop() {
 }
 
 // This function opens a Windows Bitmap (BMP) file and
-// displays it at the given coordinates.  It's sped up
-// by reading many pixels worth of data at a time
-// (rather than pixel by pixel).  Increasing the buffer
-// size takes more of the Arduino's precious RAM but
-// makes loading a little faster.  20 pixels seems a
-// good balance for tiny AVR chips.
-
-// Larger buffers are slightly more efficient, but if
-// the buffer is too large, extra data is read unnecessarily.
-// For example, if the image is 240 pixels wide, a 100
-// pixel buffer will read 3 groups of 100 pixels.  The
-// last 60 pixels from the 3rd read may not be used.
-
-#define BUFFPIXEL 80
-
+// displays it at the given coordinates.  It reads one
+// scanline at a time, and converts it while the previous
+// scanline is still going out to the display by DMA.
 
 //===========================================================
 // Try Draw using writeRect
@@ -91,15 +79,15 @@ void bmpDraw(const char *filename, uint8_t x, uint16_t y) {
   uint8_t  bmpDepth;              // Bit depth (currently must be 24)
   uint32_t bmpImageoffset;        // Start of image data in file
   uint32_t rowSize;               // Not always = bmpWidth; may have padding
-  uint8_t  sdbuffer[3*BUFFPIXEL]; // pixel buffer (R+G+B per pixel)
-  uint16_t buffidx = sizeof(sdbuffer); // Current position in sdbuffer
+  uint8_t  sdbuffer[3*320];       // one scanline (R+G+B per pixel)
   boolean  goodBmp = false;       // Set to true on valid header parse
   boolean  flip    = true;        // BMP is stored bottom-to-top
   int      w, h, row, col;
   uint8_t  r, g, b;
   uint32_t pos = 0, startTime = millis();
 
-  uint16_t awColors[320];  // hold colors for one row at a time...
+  uint16_t awColors[2][320];  // one row being converted, one being sent
+  uint8_t  cur = 0;
 
   if((x >= tft.width()) || (y >= tft.height())) return;
 
@@ -151,6 +139,7 @@ void bmpDraw(const char *filename, uint8_t x, uint16_t y) {
         if((x+w-1) >= tft.width())  w = tft.width()  - x;
         if((y+h-1) >= tft.height()) h = tft.height() - y;
 
+        tft.resetStats();
         for (row=0; row<h; row++) { // For each scanline...
 
           // Seek to start of scan line.  It might seem labor-
@@ -163,29 +152,35 @@ void bmpDraw(const char *filename, uint8_t x, uint16_t y) {
             pos = bmpImageoffset + (bmpHeight - 1 - row) * rowSize;
           else     // Bitmap is stored top-to-bottom
             pos = bmpImageoffset + row * rowSize;
-          if(bmpFile.position() != pos) { // Need seek?
-            bmpFile.seek(pos);
-            buffidx = sizeof(sdbuffer); // Force buffer reload
-          }
-
+          // The SD card shares the SPI bus, so the previous
+          // scanline has to be out before reading this one.
+          tft.waitAsyncComplete();
+          if(bmpFile.position() != pos) bmpFile.seek(pos);
+          bmpFile.read(sdbuffer, w * 3);
+
+          // Send the scanline converted last time around while
+          // this one is converted into the other buffer.
+          if (row > 0) tft.writeRectAsync(0, row - 1, w, 1, awColors[cur ^ 1]);
           for (col=0; col<w; col++) { // For each pixel...
-            // Time to read more pixel data?
-            if (buffidx >= sizeof(sdbuffer)) { // Indeed
-              bmpFile.read(sdbuffer, sizeof(sdbuffer));
-              buffidx = 0; // Set index to beginning
-            }
-
-            // Convert pixel from BMP to TFT format, push to display
-            b = sdbuffer[buffidx++];
-            g = sdbuffer[buffidx++];
-            r = sdbuffer[buffidx++];
-            awColors[col] = tft.color565(r,g,b);
+            // Convert pixel from BMP to TFT format
+            b = sdbuffer[col*3];
+            g = sdbuffer[col*3 + 1];
+            r = sdbuffer[col*3 + 2];
+            awColors[cur][col] = tft.color565(r,g,b);
           } // end pixel
-          tft.writeRect(0, row, w, 1, awColors);
+          cur ^= 1;
         } // end scanline
+        tft.writeRect(0, h - 1, w, 1, awColors[cur ^ 1]);
         Serial.print(F("Loaded in "));
         Serial.print(millis() - startTime);
         Serial.println(" ms");
+        // Each scanline after the first should continue the previous
+        // one without resending the address window
+        Serial.print(F("Row writes: "));
+        Serial.print(tft.getStats().ramwr);
+        Serial.print(F(" new window, "));
+        Serial.print(tft.getStats().ramwr_continue);
+        Serial.println(F(" continued"));
       } // end goodBmp
     }
   }